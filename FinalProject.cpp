@@ -3,6 +3,22 @@
 #include <SPI.h>
 #include <SD.h>
 #include "lcd_image.h"
+#include "lcd_tiles.h"
+#include "pacman_tiles.h"
+#include "lcd_widget.h"
+#include "lcd_compose.h"
+#include "joystick.h"
+#include "replay.h"
+#include "trace.h"
+#include "spi_stats.h"
+#include "lcd_capture.h"
+#include "sram.h"
+#include "lcd_link.h"
+#include "lockstep.h"
+#include "boot.h"
+#include "lcd_list.h"
+#include "core.h"
+#include "flight.h"
 
 #define SD_CS 5
 #define TFT_CS 6
@@ -10,8 +26,6 @@
 #define TFT_RST 8
 #define JOY_SEL 9
 
-#define JOY_VERT_ANALOG 0
-#define JOY_HORIZ_ANALOG 1
 #define JOY_CENTRE 512
 
 #define JOY_DEADZONE 500
@@ -20,6 +34,51 @@
 
 #define BUFFPIXEL 20
 
+#define NO_DOT 0xFF // Dot index lookup value for coordinates without a dot space
+
+#define SAVE_FILE "SAVE.BIN" // Snapshot written when select is pressed during a game, loaded by Resume
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_MAX_DOTS 552 // Row + collum dots a snapshot holds (multiple of 4, 4 dots are packed per byte), games on bigger maps are not saved or resynced
+
+#define SIM_GAMES 20 // Games simulated per difficulty when built with SIMULATE
+#define SIM_MAX_TICKS 20000UL // Frames after which a simulated game is stopped
+#define SIM_SEED 1 // Seed of the first simulated game, each game after it uses the next seed
+
+#define REPLAY_FILE "REPLAY.BIN" // Games are recorded to / replayed from here when built with REPLAY_RECORD / REPLAY_PLAY
+
+#define TRACE_FILE "TRACE.JSN" // Chrome trace of every frame written here when built with TRACE
+
+#define FLIGHT_FILE "FLIGHT.BIN" // The last frames before an overrun or a death are appended here when built with FLIGHT_RECORDER
+
+#define BENCH_FILE "BENCH.BIN" // Benchmark baseline, written by the first BENCHMARK build that finds none (delete it to take a new one)
+#define NUM_BENCHMARKS 14
+#define BENCH_LCD_IMAGE 12 // The lcd_image_draw benchmark, printed with the sector cache counts
+#define BENCH_DOT_LOOKUPS 3 // The first benchmarks (readDotsX, readDotsY, readDotsXY) find dots with dotIndexX and dotIndexY
+#define BENCH_ITERATIONS 200 // Calls timed per benchmark run
+#define BENCH_RUNS 3 // Runs per benchmark, the fastest one counts
+#define BENCH_FIXTURES 8 // Sprite positions the benchmarks cycle through
+#define BENCH_FIXTURE_TICKS 75 // Frames of a simulated game between fixtures
+#define BENCH_THRESHOLD 10 // Percent slower than the baseline that counts as a regression
+#define BENCH_GAMES 3 // Simulated games timed for the ticks per second figure
+
+#define LEVEL_START_MILLIS 2000 // Time from a level start or death until play, the map is drawn during it
+#define FREEZE_MILLIS 1500 // Time the screen freezes after a death or a finished level
+#define LOAD_ROWS_PER_FRAME 12 // Rows of the map image drawn per frame while a level loads
+#define MAP_TOP 9 // Screen row of the top of the map image
+#define VIEW_WIDTH 128 // Screen columns the map is shown in
+#define VIEW_HEIGHT 142 // Screen rows the map is shown in, between the score and the lives
+#define CAMERA_MARGIN 16 // Pixels from the edge of the view at which it recentres on PacMan (mazes bigger than the view)
+
+#define LINK_MAP_ROWS 1 // Link call drawing rows of the view: map number, first row, rows, cameraX and cameraY (2 bytes each)
+#define LINK_SPRITES 2 // Link call redrawing the sprites: pacManOpen, numOfGhosts, then per sprite cursorX, cursorY, delta, moveX | moveY << 1, color
+#define LINK_SPRITE_BYTES 8 // Bytes of one sprite in a LINK_SPRITES call
+
+#define MENU_REPEAT_MILLIS 150 // Time before a held joystick moves the custom menu cursor again
+
+#define NUM_MAIN_WIDGETS 4
+#define NUM_CUSTOM_WIDGETS 13
+#define CUSTOM_FIRST_VALUE 4 // Index of the first number in customWidgets, numbers follow every second widget
+
 using namespace std;
 
 // Structure for Sprites (Ghosts and PacMan)
@@ -37,10 +96,10 @@ struct sprite {
     int16_t lowerYConstraint; // Lower Y limit of movement (tunnel wall)
     int16_t upperXConstraint; // Upper X limit of movement (tunnel wall)
     int16_t upperYConstraint; // Upper Y limit of movement (tunnel wall)
-    uint8_t prevRow; // The row number of the next left or current row intersection
-    uint8_t prevCollum; // The collum number of the next upward or current collum intersection
-    uint8_t nextRow; // The row number of the next right or current row intersection
-    uint8_t nextCollum; // The collum number of the next left or current collum intersection
+    uint16_t prevRow; // The row number of the next left or current row intersection
+    uint16_t prevCollum; // The collum number of the next upward or current collum intersection
+    uint16_t nextRow; // The row number of the next right or current row intersection
+    uint16_t nextCollum; // The collum number of the next left or current collum intersection
     int color; // Color of the sprite
 };
 
@@ -56,21 +115,27 @@ struct custom {
 // Contains all relevant info for the map
 struct mapData {
     lcd_image_t* image; // lcd map image
+    lcd_tiles_t* tiles; // Tile map of the image in flash, NULL to draw the image from the SD card
     char* name; // Map name
-    uint8_t numOfRows; // Number of rows
-    uint8_t numOfCollums; //Number of Collums
+    uint16_t numOfRows; // Number of rows
+    uint16_t numOfCollums; //Number of Collums
     int16_t* rows; // Array containing the y coordinates of all rows
     int16_t* collums; // Array containing the x coordinates of all collums
     uint16_t numOfXDots; // The number of dots in a row across the entire maze
     uint16_t numOfYDots; // The number of dots in a collum across the entire maze
-    uint8_t numOfXDotsPerRow; // The number of dots in a row
-    uint8_t numOfYDotsPerCollum; // The number of dots in a collum
-    uint16_t* xDots; // Array containing dot information across all allowable row spaces. Contains 1 for full and 0 for empty
-    uint16_t* yDots; // Array containing dot information across all allowable collum spaces. Contains 1 for full and 0 for empty
+    uint16_t numOfXDotsPerRow; // The number of dots in a row
+    uint16_t numOfYDotsPerCollum; // The number of dots in a collum
+    uint8_t* xDots; // Array containing dot information across all allowable row spaces. Contains 1 for full and 0 for empty
+    uint8_t* yDots; // Array containing dot information across all allowable collum spaces. Contains 1 for full and 0 for empty
+    uint8_t* xDotsStart; // Copy of xDots as generated at the start of a level, copied back into xDots for every new level
+    uint8_t* yDotsStart; // Copy of yDots as generated at the start of a level, copied back into yDots for every new level
+    uint8_t* xDotIndex; // Index into locationOfXDots of every x coordinate from the first to the last dot space (in steps of 2), NO_DOT between spaces
+                        // (one byte per coordinate to save RAM, so a row holds at most 254 dot spaces)
+    uint8_t* yDotIndex; // Index into locationOfYDots of every y coordinate from the first to the last dot space (in steps of 2), NO_DOT between spaces
     uint16_t* locationOfXDots; // Array containing x coordinates for each of the allowable dot spaces in a row
     uint16_t* locationOfYDots; // Array containing y coordinates for each of the allowable dot spaces in a collum
-    uint8_t* locationOfCollumXDots; // Contains the location of collum dots in a collum-row intersection. Contains information in dot index
-    uint8_t* locationOfRowYDots; // Contains the location of row dots in a collum-row intersection. Contains information in dot index
+    uint16_t* locationOfCollumXDots; // Contains the location of collum dots in a collum-row intersection. Contains information in dot index
+    uint16_t* locationOfRowYDots; // Contains the location of row dots in a collum-row intersection. Contains information in dot index
     uint16_t* specialXDots; // Contains amount of special (big) dots followed by location of special dots
     uint16_t* specialYDots; // Contains amount of special (big) dots followed by location of special dots
     uint16_t* noDotsX; // Contains location of rows that exist without dots
@@ -81,30 +146,73 @@ struct mapData {
                         // First element represents the left most intersection of the first collum, the 1 + numOfRows element representing the first intersection of the second collum, etc...
     int16_t xPacManStart; // Starting X Coordinate for PacMan
     int16_t yPacManStart; // Starting Y Coordinate for Pacman
-    uint8_t PacManStartingRowPrev; // Next most upward Pacman Row intersection, since Pacman starts on a row this equals the current row number
-    uint8_t PacManStartingCollumPrev; // Next left Collum-Row intersection (in collum number)
-    uint8_t PacManStartingRowNext; // Next most downward Pacman row intersection, since PacMan starts on a row this equals the current row number
-    uint8_t PacManStartingCollumNext; // Next right Collum-Row intersection (in collum number)
-    uint8_t GhostOneStartingRowPrev; // Next most upward ghost Row, also current row for ghosts (in row number)
-    uint8_t GhostOneStartingCollumPrev; // Next left Collum-Row intersection (in collum number)
-    uint8_t GhostOneStartingRowNext; // Next most downward ghost Row, also current row for ghosts (in row number)
-    uint8_t GhostOneStartingCollumNext; // Next right Collum-Row interseciton (in collum number)
+    uint16_t PacManStartingRowPrev; // Next most upward Pacman Row intersection, since Pacman starts on a row this equals the current row number
+    uint16_t PacManStartingCollumPrev; // Next left Collum-Row intersection (in collum number)
+    uint16_t PacManStartingRowNext; // Next most downward Pacman row intersection, since PacMan starts on a row this equals the current row number
+    uint16_t PacManStartingCollumNext; // Next right Collum-Row intersection (in collum number)
+    uint16_t GhostOneStartingRowPrev; // Next most upward ghost Row, also current row for ghosts (in row number)
+    uint16_t GhostOneStartingCollumPrev; // Next left Collum-Row intersection (in collum number)
+    uint16_t GhostOneStartingRowNext; // Next most downward ghost Row, also current row for ghosts (in row number)
+    uint16_t GhostOneStartingCollumNext; // Next right Collum-Row interseciton (in collum number)
     int16_t xGhostStart; // Starting X coordinate for ghosts
     int16_t yGhostStart; // Starting Y Coordinate for ghosts
+    bool dotsGenerated; // True once xDotsStart and yDotsStart hold the generated dots
+};
+
+// Game state captured mid-level, stored in one contiguous block so it can be kept in RAM or written to the SD card as is
+struct snapshot {
+    uint8_t version; // SNAPSHOT_VERSION
+    uint16_t size; // sizeof(snapshot), catches files written by a different build
+    custom menu; // Custom menu values (includes lives left)
+    sprite pacMan; // PacMan
+    sprite ghosts[4]; // Ghosts
+    int move[8]; // Ghost move directions
+    int score; // PacMan score
+    int ghostScore; // Ghosts score
+    int oneUpScore; // Score of the next 1up
+    int resetScore; // Total score that finishes the level
+    uint8_t movement; // PacMan mouth counter
+    uint32_t seed; // The random number generator is reseeded with this on capture and restore
+    uint8_t dots[SNAPSHOT_MAX_DOTS / 4]; // Row dots followed by collum dots, 2 bits each (0 empty, 1 dot, 2 special dot)
+};
+
+// A mode of the main loop: enter runs when the mode starts, tick at most every period millis while it lasts
+// and exit when it ends. Any hook can be NULL.
+struct gameState {
+    void (*enter)();
+    void (*tick)();
+    void (*exit)();
+    uint16_t period;
+};
+
+// Totals over a number of simulated games
+struct simStats {
+    uint16_t games; // Games played
+    uint32_t ticks; // Frames survived over all games
+    uint16_t levels; // Levels finished
+    uint16_t deaths; // Lives lost
+    uint32_t pacManScore; // Points eaten by PacMan
+    uint32_t ghostScore; // Points eaten by ghosts
 };
 
 // Map Arrays for Map 1 (containing info for Map Structure)
 
 lcd_image_t mapOneImage = {"Pac-man.lcd", 128, 142};
+uint16_t mapOnePalette[4] = {ST7735_BLACK, 0x10D2, 0xE510, ST7735_BLACK}; // black, wall, dot, unused
+lcd_tiles_t mapOneTiles = {pacManTileMap, pacManTileAtlas, mapOnePalette, 128, 142}; // Pac-man.lcd in three colours, drawn in its place with MAP_TILES
 char mapOneName[10] = "PacMan";
 int16_t mapOneRow[10] = {31, 67, 95, 123, 149, 177, 205, 233, 259, 287};
 int16_t mapOneCollum[10] = {13, 31, 59, 85, 113, 141, 169, 195, 223, 241};
-uint16_t mapOneXDots[260];
-uint16_t mapOneYDots[290];
+uint8_t mapOneXDots[260];
+uint8_t mapOneYDots[290];
+uint8_t mapOneXDotsStart[260];
+uint8_t mapOneYDotsStart[290];
+uint8_t mapOneXDotIndex[115]; // (241 - 13) / 2 + 1
+uint8_t mapOneYDotIndex[129]; // (287 - 31) / 2 + 1
 uint16_t mapOneXDotSpaces[26] = {13, 23, 31, 41, 49, 59, 67, 77, 85, 95, 103, 113, 123, 131, 141, 151, 159, 169, 177, 187, 195, 205, 213, 223, 231, 241};
 uint16_t mapOneYDotSpaces[29] = {31, 41, 49, 59, 67, 77, 85, 95, 105, 113, 123, 131, 141, 149, 159, 167, 177, 187, 195, 205, 215, 223, 233, 241, 251, 259, 269, 277, 287};
-uint8_t mapOneXCollumDots[10] = {0, 2, 5, 8, 11, 14, 17, 20, 23, 25};
-uint8_t mapOneYRowDots[10] = {0, 4, 7, 10, 13, 16, 19, 22, 25, 28};
+uint16_t mapOneXCollumDots[10] = {0, 2, 5, 8, 11, 14, 17, 20, 23, 25};
+uint16_t mapOneYRowDots[10] = {0, 4, 7, 10, 13, 16, 19, 22, 25, 28};
 uint16_t specialXDots[3] = {2 ,182, 207};
 uint16_t specialYDots[3] = {2, 2, 263};
 uint16_t noDotsXMapOne[17] = {8, 78, 82, 86, 95, 99, 108, 110, 123, 125, 134, 136, 149, 151, 155, 194, 195};
@@ -114,16 +222,31 @@ uint8_t mapOneYMovement[100] = {2,3,1,0,0,0,2,1,2,1,0,0,0,0,0,0,0,2,1,0,2,3,3,3,
 
 // Map Struct for Map One:
 
-mapData mapOne = {&mapOneImage, &mapOneName[0], 10, 10, &mapOneRow[0], &mapOneCollum[0],
-                  260, 290, 26, 29, &mapOneXDots[0], &mapOneYDots[0], &mapOneXDotSpaces[0],
+#ifdef MAP_TILES
+#define MAP_ONE_TILES &mapOneTiles
+#else
+#define MAP_ONE_TILES NULL // drawn from Pac-man.lcd on the SD card
+#endif
+
+mapData mapOne = {&mapOneImage, MAP_ONE_TILES, &mapOneName[0], 10, 10, &mapOneRow[0], &mapOneCollum[0],
+                  260, 290, 26, 29, &mapOneXDots[0], &mapOneYDots[0], &mapOneXDotsStart[0], &mapOneYDotsStart[0],
+                  &mapOneXDotIndex[0], &mapOneYDotIndex[0], &mapOneXDotSpaces[0],
                   &mapOneYDotSpaces[0], &mapOneXCollumDots[0], &mapOneYRowDots[0], &specialXDots[0], &specialYDots[0], &noDotsXMapOne[0],
-                  &noDotsYMapOne[0], &mapOneXMovement[0], &mapOneYMovement[0], 127, 233, 7, 4, 7, 5, 3, 4, 3, 5, 127, 123
+                  &noDotsYMapOne[0], &mapOneXMovement[0], &mapOneYMovement[0], 127, 233, 7, 4, 7, 5, 3, 4, 3, 5, 127, 123, false
                 };
 
 mapData maps[1] = {mapOne}; // Map Array containg info for different maps. Only one for now
 
 mapData Map; // Map array used in function. Assigned a value from maps[] based on custom menu selection.
 
+int16_t cameraX = 0; // Map image column at the left of the view
+int16_t cameraY = 0; // Map image row at the top of the view
+
+// Sprite Shapes (rows of the 6x6 box around a sprite, bit c set when column c from the left is drawn)
+
+uint8_t ghostShape[6] = {0x1E, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F}; // Includes the black gap under the ghost
+uint8_t pacManShape[6] = {0x0C, 0x1E, 0x3F, 0x3F, 0x1E, 0x0C};
+
 // Struct for PacMan sprite
 
 sprite PacMan; // Will Contain info for Pacman sprite
@@ -142,6 +265,10 @@ custom menu = {1, 4, 1, 3, 1};
 
 int customMenuArray[5] = {menu.color, menu.numOfGhosts, menu.difficulty,
                           menu.lives, menu.map};
+// Top of the heap from avr-libc (0 until the first allocation), read by the benchmarks
+
+extern "C" char* __brkval;
+
 // Color Array (Called in custom menu, contains 0 at index 0 since colors range from 1-5
 
 int colorArray[6] = {0, ST7735_YELLOW, ST7735_RED, ST7735_GREEN, ST7735_BLUE,
@@ -166,9 +293,40 @@ int move[8] = {-2000, -2000, -2000, -2000, -2000, -2000, -2000, -2000}; // Info
 
 // Other
 
+bool pacManOpen = true; // True when PacMan is drawn with his mouth open
 uint8_t movement = 0; // Measures how much PacMan has moved. Resets to 0 when hitting 8, opens/closes his mouth every 4.
 uint8_t mode = 1; // Main Function mode, determines what is seen on the screen
+snapshot savedGame; // Last snapshot saved or loaded, or the state sent in a two player game
+uint8_t pacManInput = 0; // PacMan's input for the frame in a two player game (the host's joystick)
+uint8_t ghostInput = 0; // The first ghost's input for the frame in a two player game (the guest's joystick)
+bool resumeGame = false; // True when the next level start should restore savedGame instead
+bool saveHeld = false; // True while select is held during a game (saves once per press)
+
+// Level Transitions (run a frame at a time by updateTransition)
+
+uint16_t loadRow = 0; // Rows of the map image drawn so far
+bool startPending = false; // True until play starts after a level start or death
+unsigned long playTime = 0; // Time play starts
+uint8_t countdown = 0; // Countdown number on screen, 0 for none
+uint8_t storageState = 0; // SD card: 0 not started yet, 1 ready, 2 failed or on the other board
+uint8_t freezeMode = 0; // Mode to change to when the freeze ends (5 finished level, 6 death), 0 for no freeze
+unsigned long freezeEnd = 0; // Time the freeze ends
+
+bool headless = false; // True while the simulator runs games, nothing is drawn and PacMan steers himself
+core_config coreConfig = {4, 1, 3, 1}; // Settings of games played through core.h
+core_observation* coreObservation = NULL; // Caller's observation buffer, filled in by core_reset and core_step
+const uint8_t* coreInputs = NULL; // PacMan's inputs for the frames left in a core_step, NULL when he steers himself
+#if defined(LINK_SIM)
+lcd_link_tft tft = lcd_link_tft(TFT_CS, TFT_DC, TFT_RST); // Sends everything drawn to the display board
+#elif defined(DISPLAY_LIST)
+lcd_list_tft tft = lcd_list_tft(TFT_CS, TFT_DC, TFT_RST); // Draws what a frame draws once the frame ends, through the capture and traffic counts
+#elif defined(LCD_CAPTURE)
+lcd_capture_tft tft = lcd_capture_tft(TFT_CS, TFT_DC, TFT_RST); // Mirrors rows of the screen for FRAME_DUMP and FRAME_CHECK
+#elif defined(SPI_STATS)
+spi_stats_tft tft = spi_stats_tft(TFT_CS, TFT_DC, TFT_RST); // Counts what every drawing routine sends to the display
+#else
 Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_RST);
+#endif
 
 // Menu Cursors
 
@@ -176,6 +334,37 @@ uint8_t mainCursorX = 0;
 uint8_t mainCursorY = 0;
 uint8_t mainJoyX = 0;
 uint8_t mainJoyY = 0;
+unsigned long menuMoveTime = 0; // Time the custom menu cursor last moved
+bool menuJoyHeld = false; // True while the joystick is held away from centre in the custom menu
+uint16_t joyDropped = 0; // Joystick events dropped by a full queue as of the last transition
+
+// Menu Widgets (only widgets marked dirty get redrawn)
+
+lcd_widget_t mainWidgets[NUM_MAIN_WIDGETS] = {
+    {28, 30, 72, 16, 2, "PacMan", NULL, false, false, true},
+    {34, 90, 60, 8, 1, "One Player", NULL, false, true, true},
+    {46, 102, 36, 8, 1, "Custom", NULL, false, false, true},
+    {46, 114, 36, 8, 1, "Resume", NULL, false, false, true}
+};
+
+lcd_widget_t customWidgets[NUM_CUSTOM_WIDGETS] = {
+    {28, 4, 72, 16, 2, "Custom", NULL, false, false, true},
+    {40, 20, 48, 16, 2, "Menu", NULL, false, false, true},
+    {4, 40, 120, 8, 1, "(Press Sel To Begin)", NULL, false, false, true},
+    {48, 52, 30, 8, 1, "Color", NULL, true, false, true},
+    {60, 64, 6, 8, 1, NULL, &customMenuArray[0], false, true, true},
+    {16, 74, 96, 8, 1, "Number of Ghosts", NULL, true, false, true},
+    {60, 86, 6, 8, 1, NULL, &customMenuArray[1], false, false, true},
+    {33, 96, 60, 8, 1, "Difficulty", NULL, true, false, true},
+    {60, 108, 6, 8, 1, NULL, &customMenuArray[2], false, false, true},
+    {48, 118, 30, 8, 1, "Lives", NULL, true, false, true},
+    {60, 130, 6, 8, 1, NULL, &customMenuArray[3], false, false, true},
+    {54, 140, 18, 8, 1, "Map", NULL, true, false, true},
+    {60, 152, 6, 8, 1, NULL, &customMenuArray[4], false, false, true}
+};
+
+lcd_widget_t* screenWidgets = NULL; // Widgets currently on screen, NULL when anything else (the game) was drawn
+uint8_t numOfScreenWidgets = 0;
 
 /* Function Delclarations (Note: All declarations were put up here to better
                             organize definitions below due to the number of
@@ -212,6 +401,16 @@ void evaluateDirections(int*, int*, int*, int*, sprite*);
 
 int randomGenerator(int, int, int, int, int);
 
+uint8_t encodeInput(int, int);
+
+int decodeInput(uint8_t);
+
+uint32_t hashBytes(uint32_t, void*, uint16_t);
+
+uint16_t stateHash();
+
+void replayStart();
+
 int randGhost(sprite*);
 
 void scanScore();
@@ -220,9 +419,11 @@ void scanPacMan();
 
 void scanGhosts();
 
-void updateDrawnPacMan();
+void markSprite(int16_t, int16_t, uint8_t*);
 
-void updateDrawnGhosts();
+void composeRow(uint16_t*, int16_t, int16_t, uint8_t);
+
+void composeSprite(uint16_t*, int16_t, int16_t, uint8_t, sprite*, bool);
 
 void updateCursor(sprite*);
 
@@ -242,6 +443,22 @@ void updateGame();
 
 void drawMain();
 
+void drawMapRows(uint16_t, uint16_t);
+
+void drawEatenDots();
+
+void drawView();
+
+bool centreCamera();
+
+void updateCamera();
+
+bool inView(int16_t, int16_t);
+
+uint16_t viewCollums();
+
+uint16_t viewRows();
+
 void drawCustom();
 
 void updateMenuStruct();
@@ -252,18 +469,32 @@ void generateSpecialDots();
 
 void generateDots();
 
+void generateDotIndex();
+
+uint8_t dotIndexX(int16_t);
+
+uint8_t dotIndexY(int16_t);
+
+uint8_t dotSearchX(int16_t);
+
+uint8_t dotSearchY(int16_t);
+
 void createMap();
 
-void createConstraintX(sprite*);
+void createConstraintsX(sprite*);
 
-void createConstraintY(sprite*);
+void createConstraintsY(sprite*);
 
 void createPacMan();
 
 void createGhosts();
 
+void loadLevel();
+
 void loadMap();
 
+bool updateTransition();
+
 void loadPacMan();
 
 void loadGhosts();
@@ -280,69 +511,166 @@ void updateCustom();
 
 void scan();
 
-void update();
+void showWidgets(lcd_widget_t*, uint8_t);
 
-int frameDelay(int, int);
+void update();
 
 void reset();
 
+bool captureSnapshot(snapshot*);
+
+void restoreSnapshot(snapshot*);
+
+bool saveSnapshot(const char*, snapshot*);
+
+bool loadSnapshot(const char*, snapshot*);
+
+void labelResume(const char*);
+
+void limitMenuRepeat(joy_event_t*, int);
+
+void resetGhostMoves();
+
+uint8_t simulatedInput();
+
+void simulateGame(uint32_t, simStats*);
+
+void simulate();
+
+void benchmark();
+
+void tickMain();
+
+void tickCustom();
+
+void tickGame();
+
+void idle();
+
+void linkCall(uint8_t, uint8_t*, uint8_t);
+
+void linkSprites();
+
+bool lockstepFrame();
+
+void lockstepStart();
+
+int steerGhost(uint8_t, sprite*);
+
+bool startStorage();
+
+bool snapshotFits(uint8_t);
+
+void coreObserve();
+
+void coreServe();
+
+void flightFrameEnd();
+
+bool benchmarkDotIndex();
+
+void benchmarkFixtures(sprite*, sprite*);
+
+uint32_t benchmarkRun(uint8_t, sprite*, sprite*);
+
+void benchmarkTicks();
+
+// Hooks of each mode (index mode): reset() starts menus, levels and lives and picks the next mode, the
+// menus and the game tick once a frame, time left over goes to idle()
+gameState states[8] = {
+    {NULL, NULL, NULL, 0}, // 0: off
+    {reset, NULL, NULL, 0}, // 1: draws the main menu
+    {NULL, tickMain, NULL, MILLIS_PER_FRAME}, // 2: main menu
+    {reset, NULL, NULL, 0}, // 3: draws the custom menu
+    {NULL, tickCustom, NULL, MILLIS_PER_FRAME}, // 4: custom menu
+    {reset, NULL, NULL, 0}, // 5: starts a level
+    {reset, NULL, NULL, 0}, // 6: restarts a level after a death
+    {NULL, tickGame, NULL, MILLIS_PER_FRAME} // 7: game
+};
+
 void setup() {
   init();
+  sram_paint(); // lets sram_stack_peak and sram_headroom see how deep the stack gets
+  BOOT_MARK("init");
 
   Serial.begin(9600);
+  BOOT_MARK("serial");
+
+#ifdef LINK_SIM
+  // The display and SD card are on the display board, only the link and joystick are here
+  Serial1.begin(LCD_LINK_BAUD);
+  lcd_link_begin(&Serial1);
+  joy_begin(JOY_SEL);
+  storageState = 2; // the SD card is on the display board
+  Serial.println("Link started!");
+  return;
+#endif
 
   tft.initR(INITR_BLACKTAB);
+#ifdef DISPLAY_LIST_PRINT
+  tft.record(lcd_list_print); // the display list is printed in place of being drawn
+#endif
+  BOOT_MARK("tft");
 
-  Serial.print("Initializing SD card...");
-  if (!SD.begin(SD_CS)) {
-    Serial.println("failed!");
-    return;
-  }
-
-  pinMode(JOY_SEL, INPUT);
-  digitalWrite(JOY_SEL, HIGH); // enables pull-up resistor
+  joy_begin(JOY_SEL); // starts sampling the joystick in the background
   Serial.println("Joystick initialized!");
-
-  Serial.println("OK!");
-  tft.fillScreen(ST7735_BLACK);
-
+  BOOT_MARK("joystick");
+
+#ifdef LINK_RENDER
+  Serial1.begin(LCD_LINK_BAUD);
+  lcd_link_begin(&Serial1);
+#endif
+#ifdef LOCKSTEP
+  Serial2.begin(LOCKSTEP_BAUD);
+  lockstep_begin(&Serial2, &savedGame, sizeof(snapshot)); // a resync arrives in savedGame
+#endif
+
+  // The main menu is drawn from flash, the SD card is started by idle() once it is up (see startStorage)
 }
 
-/* Main works by increasing or decreasing the variable mode to change
-    what is seen on screen */
+/* Main works by changing the variable mode to change what is seen on screen,
+    one loop runs the enter, tick and exit hooks of each mode from states */
 int main() {
     setup(); // Only happens once
-    // mode = 1; Resets to the main menu, reset increases mode by 1
+#ifdef LINK_RENDER
+    // The display board only draws what the game board sends
+    startStorage();
+    while (true) {
+        lcd_link_receive(&tft, linkCall);
+    }
+#endif
+#ifdef CORE_SERIAL
+    coreServe(); // A computer plays the game through core.h
+#endif
+#ifdef SIMULATE
+    simulate(); // Prints game statistics for every difficulty before the game starts
+#endif
+#ifdef BENCHMARK
+    benchmark(); // Prints the speed of the hot functions before the game starts
+#endif
+    uint8_t state = 0; // Mode whose enter hook has run
+    unsigned long nextTick = 0; // Time the current mode ticks next
     while (mode > 0) {
-        reset();
-        // mode = 2; Displays menu and scans/updates
-        while (mode > 1) {
-            scanMain(); //Scans joystick
-            updateMain(); // Updates menu screen
-            // Mode = 3; Called when custom is selected, resets to the custom menu
-            while (mode > 2) {
-                reset();
-                // Mode = 4; Called automatically when mode = 3, use of custom menu page
-                while (mode > 3) {
-                    scanCustom(); // Scan joystick
-                    updateCustom(); // Updates cursor and custom menu struct
-                    // Mode = 5; Called when done with menu or level, creates or resets map and sprites
-                    while (mode > 4) {
-                        reset(); // Finish Level;
-                        // Mode = 6; Called when dead, resets sprites
-                        while (mode > 5) {
-                            reset(); //Dies;
-                            // Mode = 7; Main game
-                            while (mode > 6) {
-                                int Time = millis();
-                                scan();
-                                update();
-                                frameDelay(MILLIS_PER_FRAME, Time); // Ensures framerate runs at MILLIS_PER_FRAME
-                            }
-                        }
-                    }
-                }
+        // A new mode leaves the old state and enters the new one, reset() as an enter hook moves on to the next mode at once
+        if (mode != state) {
+            if (states[state].exit != NULL) {
+                states[state].exit();
             }
+            state = mode;
+            nextTick = millis();
+            if (states[state].enter != NULL) {
+                states[state].enter();
+            }
+            LCD_LIST_FRAME_END(tft); // Draws what the enter hook drew
+        }
+        // Ticks at most once every period
+        else if (states[state].tick != NULL && (long) (millis() - nextTick) >= 0) {
+            nextTick = millis() + states[state].period;
+            states[state].tick();
+            LCD_LIST_FRAME_END(tft); // Draws the frame, or queues it for idle() with DISPLAY_LIST_PIPELINE
+        }
+        else {
+            idle();
         }
     }
     Serial.end();
@@ -353,12 +681,300 @@ int main() {
     Functions are arranged in alphabetical order in order to make finding them easier
 */
 
+// Times the hot functions on sprite positions from a simulated game, prints ns/op and compares them with the baseline on the SD card
+void benchmark() {
+    const char* names[NUM_BENCHMARKS] = {"readDotsX", "readDotsY", "readDotsXY", "createConstraintsX", "createConstraintsY",
+                                         "updateConstraintsX", "updateConstraintsY", "updatePrevNextX", "updatePrevNextY",
+                                         "randGhost", "randomGenerator", "generateDots", "lcd_image_draw", "lcd_tiles_draw"};
+    sprite pacMen[BENCH_FIXTURES];
+    sprite ghosts[BENCH_FIXTURES];
+    uint32_t nanos[NUM_BENCHMARKS];
+    uint32_t baseline[NUM_BENCHMARKS];
+    bool haveBaseline = false;
+
+    Serial.println("Benchmarking...");
+    startStorage(); // the baseline is on the SD card
+    bool dotsFound = benchmarkDotIndex(); // The dot lookups are only timed if they find the dots the searches found
+    benchmarkTicks();
+    benchmarkFixtures(pacMen, ghosts);
+
+    File file = SD.open(BENCH_FILE);
+    if (file) {
+        haveBaseline = file.read((uint8_t*) baseline, sizeof(baseline)) == sizeof(baseline);
+        file.close();
+    }
+
+    for (uint8_t bench = 0; bench < NUM_BENCHMARKS; bench++) {
+        if (bench < BENCH_DOT_LOOKUPS && !dotsFound) {
+            nanos[bench] = 0;
+            Serial.print(names[bench]);
+            Serial.println(": FAILED, the dot lookups differ from the searches");
+            continue;
+        }
+        uint32_t fastest = 0xFFFFFFFF;
+        char* heap = __brkval;
+        uint32_t hits = lcd_image_cache_hits();
+        uint32_t misses = lcd_image_cache_misses();
+        uint32_t evictions = lcd_image_cache_evictions();
+        for (uint8_t run = 0; run < BENCH_RUNS; run++) {
+            // The loop and fixture copies are timed on their own and taken off
+            uint32_t time = benchmarkRun(bench, pacMen, ghosts);
+            uint32_t overhead = benchmarkRun(NUM_BENCHMARKS, pacMen, ghosts);
+            fastest = min(fastest, (time > overhead) ? time - overhead : 0);
+            // Dots eaten by readDots come back for the next run
+            memcpy(Map.xDots, Map.xDotsStart, Map.numOfXDots);
+            memcpy(Map.yDots, Map.yDotsStart, Map.numOfYDots);
+        }
+        nanos[bench] = fastest * 1000 / BENCH_ITERATIONS;
+
+        Serial.print(names[bench]);
+        Serial.print(": ");
+        Serial.print(nanos[bench]);
+        Serial.print(" ns/op, heap +");
+        Serial.print((int) (__brkval - heap)); // the game has no other allocations to count
+        Serial.print(" B");
+        if (bench == BENCH_LCD_IMAGE) {
+            Serial.print(", sector cache ");
+            Serial.print(lcd_image_cache_hits() - hits);
+            Serial.print(" hits ");
+            Serial.print(lcd_image_cache_misses() - misses);
+            Serial.print(" misses ");
+            Serial.print(lcd_image_cache_evictions() - evictions);
+            Serial.print(" evictions");
+        }
+        if (haveBaseline) {
+            long change = ((long) nanos[bench] - (long) baseline[bench]) * 100 / (long) max(baseline[bench], 1UL);
+            Serial.print(" (baseline ");
+            Serial.print(baseline[bench]);
+            Serial.print(", ");
+            Serial.print(change);
+            Serial.print("%)");
+            if (change > BENCH_THRESHOLD) {
+                Serial.print(" REGRESSION");
+            }
+        }
+        Serial.println();
+    }
+
+    // The first run becomes the baseline, unless it has failed benchmarks
+    if (!haveBaseline && dotsFound) {
+        SD.remove(BENCH_FILE);
+        file = SD.open(BENCH_FILE, FILE_WRITE);
+        if (file) {
+            file.write((uint8_t*) nanos, sizeof(nanos));
+            file.close();
+            Serial.println("Baseline saved");
+        }
+    }
+    headless = false;
+}
+
+// Checks dotIndexX and dotIndexY against the searches they replaced for every coordinate of every map, true if they agree
+bool benchmarkDotIndex() {
+    uint32_t checked = 0;
+    uint16_t differ = 0;
+
+    for (uint8_t map = 1; map <= sizeof(maps) / sizeof(maps[0]); map++) {
+        menu.map = map;
+        createMap(); // Map and its lookups
+        for (int16_t x = -2; x <= 2 * (int16_t) (*Map.image).ncols + 2; x++) {
+            differ += (dotIndexX(x) != dotSearchX(x));
+            checked++;
+        }
+        for (int16_t y = -2; y <= 2 * (int16_t) ((*Map.image).nrows + MAP_TOP) + 2; y++) {
+            differ += (dotIndexY(y) != dotSearchY(y));
+            checked++;
+        }
+    }
+    Serial.print("Dot lookups: ");
+    Serial.print(checked);
+    Serial.print(" coordinates checked against the searches, ");
+    Serial.print(differ);
+    Serial.println(differ == 0 ? " differ" : " differ MISMATCH");
+    return differ == 0;
+}
+
+// Plays a game without drawing and keeps PacMan and the first ghost as fixtures whenever the ghost
+// reaches an intersection at least BENCH_FIXTURE_TICKS frames after the last fixture
+void benchmarkFixtures(sprite* pacMen, sprite* ghosts) {
+    uint8_t fixture = 0;
+    uint32_t nextTick = 0;
+
+    headless = true;
+    randomSeed(SIM_SEED);
+    menu.color = 1;
+    menu.numOfGhosts = 4;
+    menu.difficulty = 2;
+    menu.lives = 3;
+    menu.map = 1;
+    createMap();
+    for (uint32_t tick = 0; fixture < BENCH_FIXTURES && tick < SIM_MAX_TICKS; tick++) {
+        // Start again from the starting positions after a death or a finished level
+        if (freezeMode != 0 || tick == 0) {
+            createPacMan();
+            createGhosts();
+            movement = 0;
+            resetGhostMoves();
+            freezeMode = 0;
+        }
+        if (tick >= nextTick && (((*GhostPointer).moveX && (*GhostPointer).modeY) || ((*GhostPointer).moveY && (*GhostPointer).modeX))) {
+            pacMen[fixture] = PacMan;
+            ghosts[fixture] = *GhostPointer;
+            fixture++;
+            nextTick = tick + BENCH_FIXTURE_TICKS;
+        }
+        scan();
+        update();
+    }
+    // A short game repeats its last fixture
+    for (uint8_t copy = max(fixture, 1); copy < BENCH_FIXTURES; copy++) {
+        pacMen[copy] = pacMen[copy - 1];
+        ghosts[copy] = ghosts[copy - 1];
+    }
+    freezeMode = 0;
+}
+
+// Times BENCH_ITERATIONS calls of one benchmark in micros, NUM_BENCHMARKS times the loop alone
+uint32_t benchmarkRun(uint8_t bench, sprite* pacMen, sprite* ghosts) {
+    sprite Object;
+    uint32_t start = micros();
+
+    for (uint16_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+        // Every call gets a fresh copy, the functions move and change the sprite
+        Object = (bench == 9) ? ghosts[iteration % BENCH_FIXTURES] : pacMen[iteration % BENCH_FIXTURES];
+        switch (bench) {
+            case 0:
+                readDotsX(&Object);
+                break;
+            case 1:
+                readDotsY(&Object);
+                break;
+            case 2:
+                readDotsXY(&Object);
+                break;
+            case 3:
+                createConstraintsX(&Object);
+                break;
+            case 4:
+                createConstraintsY(&Object);
+                break;
+            case 5:
+                updateConstraintsX(&Object);
+                break;
+            case 6:
+                updateConstraintsY(&Object);
+                break;
+            case 7:
+                updatePrevNextX(&Object);
+                break;
+            case 8:
+                updatePrevNextY(&Object);
+                break;
+            case 9:
+                randGhost(&Object);
+                break;
+            case 10:
+                randomGenerator(3, 3, 3, 3, 12);
+                break;
+            case 11:
+                generateDots();
+                break;
+            case 12:
+                lcd_image_draw(Map.image, &tft, 0, 0, 0, MAP_TOP, 8, 8); // served from the sector cache after the first call
+                break;
+            case 13:
+                lcd_tiles_draw(&mapOneTiles, &tft, 0, 0, 0, MAP_TOP, 8, 8); // timed whether or not the map is drawn with it
+                break;
+        }
+    }
+    return micros() - start;
+}
+
+// Times whole simulated games and prints the frames the game logic plays per second without drawing
+void benchmarkTicks() {
+    core_config config = {4, 2, 3, 1};
+    core_observation observation;
+    uint32_t ticks = 0;
+
+    core_create(&config, &observation);
+    uint32_t start = micros();
+    for (uint8_t game = 0; game < BENCH_GAMES; game++) {
+        core_reset(SIM_SEED + game);
+        ticks += core_step(NULL, SIM_MAX_TICKS);
+    }
+    uint32_t time = micros() - start;
+    freezeMode = 0;
+
+    Serial.print("Simulator: ");
+    Serial.print(ticks * 1000 / max(time / 1000, 1UL));
+    Serial.print(" ticks/s (");
+    Serial.print(ticks);
+    Serial.print(" ticks in ");
+    Serial.print(time / 1000);
+    Serial.println(" ms)");
+}
+
+// Copies the game state into a snapshot and reseeds the random number generator with the snapshot seed,
+// false (and nothing copied) if the map has more dots than a snapshot holds
+bool captureSnapshot(snapshot* Snapshot) {
+    uint16_t dot;
+    uint8_t value;
+
+    if (!snapshotFits(menu.map)) {
+        return false;
+    }
+    (*Snapshot).version = SNAPSHOT_VERSION;
+    (*Snapshot).size = sizeof(snapshot);
+    (*Snapshot).menu = menu;
+    (*Snapshot).pacMan = PacMan;
+    memcpy((*Snapshot).ghosts, Ghosts, sizeof(Ghosts));
+    memcpy((*Snapshot).move, move, sizeof(move));
+    (*Snapshot).score = score;
+    (*Snapshot).ghostScore = ghostScore;
+    (*Snapshot).oneUpScore = oneUpScore;
+    (*Snapshot).resetScore = resetScore;
+    (*Snapshot).movement = movement;
+
+    // Packs the row dots then the collum dots, 4 per byte
+    memset((*Snapshot).dots, 0, sizeof((*Snapshot).dots));
+    for (dot = 0; dot < Map.numOfXDots + Map.numOfYDots; dot++) {
+        if (dot < Map.numOfXDots) {
+            value = *(Map.xDots + dot);
+        }
+        else {
+            value = *(Map.yDots + dot - Map.numOfXDots);
+        }
+        // 5 (special) is stored as 2
+        if (value == 5) {
+            value = 2;
+        }
+        (*Snapshot).dots[dot / 4] |= value << (2 * (dot % 4));
+    }
+
+    // The generator's state can't be read, so both this game and a restored one continue from the same new seed
+    (*Snapshot).seed = random(0x7FFFFFFF);
+    randomSeed(FLIGHT_SEED((*Snapshot).seed));
+    return true;
+}
+
+// Centres the view on PacMan as far as the edges of the maze allow, true if it moved
+bool centreCamera() {
+    int16_t x = constrain(PacMan.cursorX/2 - VIEW_WIDTH/2, 0, (int16_t) ((*Map.image).ncols - viewCollums()));
+    int16_t y = constrain(PacMan.cursorY/2 - MAP_TOP - VIEW_HEIGHT/2, 0, (int16_t) ((*Map.image).nrows - viewRows()));
+    if (x == cameraX && y == cameraY) {
+        return false;
+    }
+    cameraX = x;
+    cameraY = y;
+    return true;
+}
+
 // Increases and decreases the probabilities of ghost moving in certain directions based on psition and difficulty
 void changeProbabilities(int* up, int* down, int* left, int* right, sprite* Object) {
     int16_t startingChange; // Starts changing probabilities at this distance
     int16_t changeIncrement; // Changes probabilities further every changeIncrement
-    uint8_t numOfXChanges; // Number of changes x
-    uint8_t numOfYChanges; // Number of changes y
+    uint8_t numOfXChanges = 0; // Number of changes x
+    uint8_t numOfYChanges = 0; // Number of changes y
     uint8_t numOfAllowedChanges; // Number of changes allowed based on difficulty
     // Determines how function works based on difficulty
     switch (menu.difficulty) {
@@ -432,6 +1048,230 @@ void changeProbabilities(int* up, int* down, int* left, int* right, sprite* Obje
     }
 }
 
+// Builds the final pixels of part of a screen row for the compositor: map walls, then ghosts, then PacMan on top
+void composeRow(uint16_t* line, int16_t x, int16_t y, uint8_t width) {
+    // Walls come back from the tile map, dots under a sprite are erased whether eaten or not, like drawGhostBlack
+    if (Map.tiles != NULL && y >= MAP_TOP && y - MAP_TOP + cameraY < (*Map.tiles).nrows) {
+        lcd_tiles_row(Map.tiles, line, x + cameraX, y - MAP_TOP + cameraY, width);
+        for (uint8_t pixel = 0; pixel < width; pixel++) {
+            if (line[pixel] == (*Map.tiles).palette[PACMAN_TILE_DOT]) {
+                line[pixel] = ST7735_BLACK;
+            }
+        }
+    }
+    else {
+        for (uint8_t pixel = 0; pixel < width; pixel++) {
+            line[pixel] = ST7735_BLACK; // sprites erase to black, like drawGhostBlack
+        }
+    }
+    for (uint8_t ghost = 0; ghost < menu.numOfGhosts; ghost++) {
+        composeSprite(line, x, y, width, GhostPointer + ghost, true);
+    }
+    composeSprite(line, x, y, width, &PacMan, false);
+}
+
+// Draws the part of a sprite on screen row y into line, with the same pixels as drawGhost, drawPacMan and drawCircle
+void composeSprite(uint16_t* line, int16_t x, int16_t y, uint8_t width, sprite* Object, bool ghost) {
+    int16_t left = (*Object).cursorX/2 - cameraX - 2; // left screen column of the sprite box
+    int16_t row = y - ((*Object).cursorY/2 - cameraY - 2); // row within the sprite box
+    uint8_t clear = 0; // columns left see-through (ghost gap, PacMan mouth)
+    uint8_t white = 0; // columns drawn white (ghost eyes)
+    uint8_t black = 0; // columns drawn black (ghost pupils)
+
+    if (row < 0 || row > 5) {
+        return;
+    }
+    if (ghost) {
+        // Eye columns depend on which way the ghost looks
+        uint8_t eyes = (1 << 2) | (1 << 4);
+        if ((*Object).moveX) {
+            eyes = ((*Object).delta > 0) ? (1 << 3) | (1 << 5) : (1 << 1) | (1 << 3);
+        }
+        if (row == 1) {
+            white = eyes;
+        }
+        else if (row == 2) {
+            black = eyes;
+        }
+        else if (row == 5) {
+            clear = 0x0C;
+        }
+    }
+    else if (pacManOpen) {
+        // Mouth points the way PacMan moves
+        if (PacMan.moveY) {
+            if ((PacMan.delta < 0 && row <= 2) || (PacMan.delta > 0 && row >= 3)) {
+                clear = 0x0C;
+            }
+        }
+        else if (row == 2 || row == 3) {
+            clear = (PacMan.delta > 0) ? 0x38 : 0x07;
+        }
+    }
+
+    uint8_t shape = ghost ? ghostShape[row] : pacManShape[row];
+    for (uint8_t column = 0; column < 6; column++) {
+        int16_t pixel = left + column - x;
+        uint8_t bit = 1 << column;
+        if (pixel < 0 || pixel >= width || !(shape & bit) || (clear & bit)) {
+            continue;
+        }
+        if (white & bit) {
+            line[pixel] = ST7735_WHITE;
+        }
+        else if (black & bit) {
+            line[pixel] = ST7735_BLACK;
+        }
+        else {
+            line[pixel] = (*Object).color;
+        }
+    }
+}
+
+// Sets up games played through core.h
+void core_create(core_config* config, core_observation* observation) {
+    coreConfig = *config;
+    coreObservation = observation;
+}
+
+// Returns the caller's observation buffer
+core_observation* core_observe() {
+    return coreObservation;
+}
+
+// Starts a game through core.h on the first level, without drawing (same as reset() modes 5 and 6)
+void core_reset(uint32_t seed) {
+    headless = true;
+    srandom(seed); // Every game gets its own repeatable stream of random numbers, randomSeed would ignore a seed of 0
+    menu.color = 1;
+    menu.numOfGhosts = coreConfig.numOfGhosts;
+    menu.difficulty = coreConfig.difficulty;
+    menu.lives = coreConfig.lives;
+    menu.map = coreConfig.map;
+    score = 0;
+    prevScore = 0;
+    ghostScore = 0;
+    totalScore = 0;
+    oneUpScore = 3000;
+    resetScore = 2560;
+    freezeMode = 0;
+    createMap();
+    createPacMan();
+    createGhosts();
+    movement = 0;
+    resetGhostMoves();
+    headless = false;
+
+    memset(coreObservation, 0, sizeof(core_observation));
+    coreObserve();
+}
+
+// Plays frames of a game through core.h without drawing, until ticks frames are played or the game is over
+uint32_t core_step(const uint8_t* inputs, uint32_t ticks) {
+    uint32_t tick;
+
+    headless = true;
+    coreInputs = inputs;
+    for (tick = 0; tick < ticks && menu.lives > 0; tick++) {
+        // Next level, same as reset() mode 5 without the drawing
+        if (freezeMode == 5) {
+            createMap();
+            resetScore += 2560;
+        }
+        // After a finished level or a death, same as reset() mode 6
+        if (freezeMode != 0) {
+            createPacMan();
+            createGhosts();
+            movement = 0;
+            resetGhostMoves();
+            freezeMode = 0;
+        }
+
+        scan();
+        update();
+
+        // updateGame asks for a freeze when a level is finished (5) or PacMan died (6)
+        if (freezeMode == 5) {
+            (*coreObservation).levels++;
+        }
+        else if (freezeMode == 6) {
+            (*coreObservation).deaths++;
+        }
+    }
+    coreInputs = NULL;
+    headless = false;
+
+    (*coreObservation).ticks += tick;
+    coreObserve();
+    return tick;
+}
+
+// Fills in the caller's observation buffer, the dots are pointed at rather than copied
+void coreObserve() {
+    (*coreObservation).version = CORE_VERSION;
+    (*coreObservation).numOfGhosts = menu.numOfGhosts;
+    (*coreObservation).lives = menu.lives;
+    (*coreObservation).score = score;
+    (*coreObservation).ghostScore = ghostScore;
+    (*coreObservation).pacManX = PacMan.cursorX;
+    (*coreObservation).pacManY = PacMan.cursorY;
+    for (n = 0; n < CORE_MAX_GHOSTS; n++) {
+        (*coreObservation).ghostX[n] = Ghosts[n].cursorX;
+        (*coreObservation).ghostY[n] = Ghosts[n].cursorY;
+    }
+    (*coreObservation).numOfXDots = Map.numOfXDots;
+    (*coreObservation).numOfYDots = Map.numOfYDots;
+    (*coreObservation).xDots = Map.xDots;
+    (*coreObservation).yDots = Map.yDots;
+}
+
+// Lets a computer play through core.h over Serial (CORE_SERIAL), see core.h for the commands
+void coreServe() {
+    core_config config = coreConfig;
+    core_observation observation;
+    uint8_t inputs[CORE_SERIAL_INPUTS];
+    uint32_t seed;
+    uint16_t ticks;
+
+    core_create(&config, &observation);
+    core_reset(0);
+    Serial.println("Core ready");
+    while (true) {
+        if (Serial.available() == 0) {
+            continue;
+        }
+        switch (Serial.read()) {
+            case 'C':
+                Serial.readBytes((uint8_t*) &config, sizeof(config));
+                core_create(&config, &observation);
+                break;
+            case 'R':
+                Serial.readBytes((uint8_t*) &seed, sizeof(seed));
+                core_reset(seed);
+                break;
+            case 'S':
+                // The inputs are read and played a buffer at a time
+                Serial.readBytes((uint8_t*) &ticks, sizeof(ticks));
+                while (ticks > 0) {
+                    uint8_t count = min(ticks, CORE_SERIAL_INPUTS);
+                    Serial.readBytes(inputs, count);
+                    core_step(inputs, count);
+                    ticks -= count;
+                }
+                break;
+            case 'A':
+                Serial.readBytes((uint8_t*) &ticks, sizeof(ticks));
+                core_step(NULL, ticks);
+                break;
+            case 'O':
+                Serial.write((uint8_t*) &observation, offsetof(core_observation, xDots));
+                Serial.write(observation.xDots, observation.numOfXDots);
+                Serial.write(observation.yDots, observation.numOfYDots);
+                break;
+        }
+    }
+}
+
 // Initializes the minimum and maximum X values (wall boundaries)
 void createConstraintsX(sprite* Object) {
     // If the sprite is in a row...
@@ -440,11 +1280,11 @@ void createConstraintsX(sprite* Object) {
                 i starts at the intersection right of sprite within the row
                 i loops through each potential intersection until the last collum
           */
-          for (i = ((*Object).nextCollum + ((*Object).nextRow * Map.numOfRows)); i < Map.numOfCollums + ((*Object).nextRow * Map.numOfRows); ++i) {
+          for (i = ((*Object).nextCollum + ((*Object).nextRow * Map.numOfCollums)); i < Map.numOfCollums + ((*Object).nextRow * Map.numOfCollums); ++i) {
               // If the value is 1 (1 meaning a right wall)
               if (*(Map.xMovement + i) == 1) {
                   // Evaluates the x coordinate of the wall based on the value of i
-                  (*Object).upperXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfRows)));
+                  (*Object).upperXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfCollums)));
                   break;
               }
           }
@@ -452,11 +1292,11 @@ void createConstraintsX(sprite* Object) {
                 i starts at the intersection left of sprite within the row
                 i loops through each potential intersection until the first collum
           */
-          for (i = ((*Object).prevCollum + ((*Object).nextRow * Map.numOfRows)); i >= ((*Object).nextRow * Map.numOfRows); --i) {
+          for (i = ((*Object).prevCollum + ((*Object).nextRow * Map.numOfCollums)); i >= ((*Object).nextRow * Map.numOfCollums); --i) {
               // If the value is 2 (2 meaning a left wall)
               if (*(Map.xMovement + i) == 2) {
                   // Evaluates the x coordinate of the wall based on the value of i
-                  (*Object).lowerXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfRows)));
+                  (*Object).lowerXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfCollums)));
                   break;
               }
           }
@@ -477,7 +1317,7 @@ void createConstraintsY(sprite* Object) {
             i starts at the intersection below sprite within the row
             i loops through each potential intersection until the last row
         */
-        for (i = ((*Object).nextRow + ((*Object).nextCollum * (Map.numOfCollums))); i < (Map.numOfRows + ((*Object).nextCollum * Map.numOfCollums)); ++i) {
+        for (i = ((*Object).nextRow + ((*Object).nextCollum * Map.numOfRows)); i < (Map.numOfRows + ((*Object).nextCollum * Map.numOfRows)); ++i) {
             // If the value is a 1 (1 meaning bottom wall)
             if (*(Map.yMovement + i) == 1) {
                 // Updates upper Y constraint based on i's value in Map.rows
@@ -489,11 +1329,11 @@ void createConstraintsY(sprite* Object) {
             i starts at the intersection above sprite within the row
             i loops through each potential intersection until the last row
         */
-        for (i = ((*Object).prevRow + ((*Object).nextCollum * Map.numOfCollums)); i >= ((*Object).nextCollum * Map.numOfCollums); --i) {
+        for (i = ((*Object).prevRow + ((*Object).nextCollum * Map.numOfRows)); i >= ((*Object).nextCollum * Map.numOfRows); --i) {
             // If the value is a 2 (2 meaning top wall)
             if (*(Map.yMovement + i) == 2) {
                 // Updates lower Y constraint based on i's value in Map.rows (which is modulated in this case by 10)
-                (*Object).lowerYConstraint = *(Map.rows + (i - ((*Object).nextCollum * Map.numOfCollums)));
+                (*Object).lowerYConstraint = *(Map.rows + (i - ((*Object).nextCollum * Map.numOfRows)));
                 break;
             }
         }
@@ -524,7 +1364,18 @@ void createGhosts() {
 // Creates data for Map Structure to be used in program
 void createMap() {
     Map = maps[menu.map - 1]; // Equals specified map in custom menu
-    generateDots(); // Generate the full and empty dots in map
+    // The dots are only generated the first time a map is played, every level after that copies them
+    if (!Map.dotsGenerated) {
+        generateDots(); // Generate the full and empty dots in map
+        generateDotIndex(); // Generate the coordinate to dot lookups
+        memcpy(Map.xDotsStart, Map.xDots, Map.numOfXDots);
+        memcpy(Map.yDotsStart, Map.yDots, Map.numOfYDots);
+        maps[menu.map - 1].dotsGenerated = true;
+    }
+    else {
+        memcpy(Map.xDots, Map.xDotsStart, Map.numOfXDots);
+        memcpy(Map.yDots, Map.yDotsStart, Map.numOfYDots);
+    }
 }
 
 // Creates data for PacMan Structure to be used in program
@@ -540,8 +1391,66 @@ void createPacMan() {
     createConstraintsY(&PacMan);
 }
 
+// Turns a 2 bit joystick direction from encodeInput back into a joystick reading
+int decodeInput(uint8_t direction) {
+    switch (direction) {
+        case 1:
+            return 0; // left or up
+        case 2:
+            return 1023; // right or down
+        default:
+            return JOY_CENTRE;
+    }
+}
+
+// Returns the index into locationOfXDots of the dot space at x coordinate, or NO_DOT
+uint8_t dotIndexX(int16_t xCoordinate) {
+    // Coordinates left of the first space wrap around to large numbers and fail the range check
+    uint16_t offset = (uint16_t) (xCoordinate - *Map.locationOfXDots);
+    // Dot spaces are an even distance apart, odd offsets fall between them
+    if ((offset & 1) || offset / 2 > (*(Map.locationOfXDots + Map.numOfXDotsPerRow - 1) - *Map.locationOfXDots) / 2) {
+        return NO_DOT;
+    }
+    return *(Map.xDotIndex + offset / 2);
+}
+
+// Returns the index into locationOfYDots of the dot space at y coordinate, or NO_DOT
+uint8_t dotIndexY(int16_t yCoordinate) {
+    // Coordinates above the first space wrap around to large numbers and fail the range check
+    uint16_t offset = (uint16_t) (yCoordinate - *Map.locationOfYDots);
+    // Dot spaces are an even distance apart, odd offsets fall between them
+    if ((offset & 1) || offset / 2 > (*(Map.locationOfYDots + Map.numOfYDotsPerCollum - 1) - *Map.locationOfYDots) / 2) {
+        return NO_DOT;
+    }
+    return *(Map.yDotIndex + offset / 2);
+}
+
+// Reference for dotIndexX: searches the dot spaces of a row for xCoordinate, NO_DOT if it is not one (checked by benchmarkDotIndex)
+uint8_t dotSearchX(int16_t xCoordinate) {
+    for (uint8_t index = 0; index < Map.numOfXDotsPerRow; index++) {
+        if (*(Map.locationOfXDots + index) == xCoordinate) {
+            return index;
+        }
+    }
+    return NO_DOT;
+}
+
+// Reference for dotIndexY: searches the dot spaces of a collum for yCoordinate, NO_DOT if it is not one
+uint8_t dotSearchY(int16_t yCoordinate) {
+    for (uint8_t index = 0; index < Map.numOfYDotsPerCollum; index++) {
+        if (*(Map.locationOfYDots + index) == yCoordinate) {
+            return index;
+        }
+    }
+    return NO_DOT;
+}
+
 // Draws a circle with diameter 6 pixels with specified color centered at xCoordinate/2 and yCoordinate/2
 void drawCircle(int16_t xCoordinate, int16_t yCoordinate, int color) {
+    SPI_STATS_SCOPE("drawCircle");
+    if (headless) {
+        return; // nothing is drawn while simulating
+    }
     tft.drawLine(xCoordinate/2 - 2, yCoordinate/2, xCoordinate/2 - 2, yCoordinate/2 + 1, color);
     tft.drawLine(xCoordinate/2 - 1, yCoordinate/2 - 1, xCoordinate/2 - 1, yCoordinate/2 + 2, color);
     tft.drawLine(xCoordinate/2, yCoordinate/2 - 2, xCoordinate/2, yCoordinate/2 + 3, color);
@@ -552,62 +1461,40 @@ void drawCircle(int16_t xCoordinate, int16_t yCoordinate, int color) {
 
 // Draws the custom menu
 void drawCustom() {
-    tft.fillScreen(ST7735_BLACK); // init black
-
-    // Print Custom Menu at Top
-    tft.setCursor(28, 4);
-    tft.setTextSize(2);
-    tft.setTextColor(0xFFFF, 0x0000);
-    tft.print("Custom");
-    tft.setCursor(40, 20);
-    tft.print("Menu");
-
-    // Print Sel to Begin Message
-    tft.setTextSize(1);
-    tft.setCursor(4,40);
-    tft.print("(Press Sel To Begin)");
-
-    // Print Color and it's number
-    tft.setCursor(48, 52);
-    tft.print("Color");
-    tft.drawLine(47, 60, 77, 60, ST7735_WHITE);
-    tft.setTextColor(0x0000,0xFFFF);
-    tft.setCursor(60, 64);
-    tft.print(menu.color);
-
-    // Print Number of Ghosts and it's number
-    tft.setCursor(16, 74);
-    tft.setTextColor(0xFFFF, 0x0000);
-    tft.print("Number of Ghosts");
-    tft.drawLine(15, 82, 111, 82, ST7735_WHITE);
-    tft.setCursor(60, 86);
-    tft.print(menu.numOfGhosts);
-
-    // Print Difficulty and its number
-    tft.setCursor(33, 96);
-    tft.print("Difficulty");
-    tft.drawLine(32, 104, 92, 104, ST7735_WHITE);
-    tft.setCursor(60, 108);
-    tft.print(menu.difficulty);
-
-    // Print Lives and its number
-    tft.setCursor(48, 118);
-    tft.print("Lives");
-    tft.drawLine(47, 126, 77, 126, ST7735_WHITE);
-    tft.setCursor(60, 130);
-    tft.print(menu.lives);
-
-    // Print Map and its number
-    tft.setCursor(54, 140);
-    tft.print("Map");
-    tft.drawLine(53, 148, 71, 148, ST7735_WHITE);
-    tft.setCursor(60, 152);
-    tft.print(menu.map);
+    // Select the first number (color)
+    for (i = 0; i < 5; i++) {
+        customWidgets[CUSTOM_FIRST_VALUE + (2 * i)].selected = (i == 0);
+    }
+    showWidgets(customWidgets, NUM_CUSTOM_WIDGETS);
+}
 
+// Erases the eaten dots in the view, which the map image still shows
+void drawEatenDots() {
+    int16_t dotX, dotY;
+    for (uint16_t dot = 0; dot < Map.numOfXDots; dot++) {
+        dotX = *(Map.locationOfXDots + (dot % Map.numOfXDotsPerRow));
+        dotY = *(Map.rows + (dot / Map.numOfXDotsPerRow));
+        if (*(Map.xDots + dot) == 0 && *(Map.xDotsStart + dot) != 0 && inView(dotX, dotY)) {
+            drawCircle(dotX - 2 * cameraX, dotY - 2 * cameraY, ST7735_BLACK);
+        }
+    }
+    for (uint16_t dot = 0; dot < Map.numOfYDots; dot++) {
+        dotX = *(Map.collums + (dot / Map.numOfYDotsPerCollum));
+        dotY = *(Map.locationOfYDots + (dot % Map.numOfYDotsPerCollum));
+        if (*(Map.yDots + dot) == 0 && *(Map.yDotsStart + dot) != 0 && inView(dotX, dotY)) {
+            drawCircle(dotX - 2 * cameraX, dotY - 2 * cameraY, ST7735_BLACK);
+        }
+    }
 }
 
 // Draws Ghost centered at xCoordinate/2 and yCoordinate/2
 void drawGhost(int16_t xCoordinate, int16_t yCoordinate, sprite* Object) {
+    SPI_STATS_SCOPE("drawGhost");
+    if (headless || !inView(xCoordinate, yCoordinate)) {
+        return; // nothing is drawn while simulating, or outside the view
+    }
+    xCoordinate -= 2 * cameraX; // map to screen coordinates
+    yCoordinate -= 2 * cameraY;
     // Draws Ghost Body
     tft.fillRect(xCoordinate/2 - 2, yCoordinate/2 - 1, 6, 5, (*Object).color);
     tft.fillRect(xCoordinate/2 - 1, yCoordinate/2 - 2, 4, 1, (*Object).color);
@@ -640,6 +1527,12 @@ void drawGhost(int16_t xCoordinate, int16_t yCoordinate, sprite* Object) {
 
 // Draws an all black ghost
 void drawGhostBlack(int16_t xCoordinate, int16_t yCoordinate) {
+    SPI_STATS_SCOPE("drawGhostBlack");
+    if (headless || !inView(xCoordinate, yCoordinate)) {
+        return; // nothing is drawn while simulating, or outside the view
+    }
+    xCoordinate -= 2 * cameraX; // map to screen coordinates
+    yCoordinate -= 2 * cameraY;
     tft.fillRect(xCoordinate/2 - 2, yCoordinate/2 - 1, 6, 5, ST7735_BLACK);
     tft.fillRect(xCoordinate/2 - 1, yCoordinate/2 - 2, 4, 1, ST7735_BLACK);
     tft.fillRect(xCoordinate/2, yCoordinate/2 + 3, 2, 1, ST7735_BLACK);
@@ -647,27 +1540,41 @@ void drawGhostBlack(int16_t xCoordinate, int16_t yCoordinate) {
 
 // Draws the main menu
 void drawMain() {
-    tft.fillScreen(ST7735_BLACK); // init black
-
-    // Print PacMan
-    tft.setCursor(28, 30);
-    tft.setTextSize(2);
-    tft.print("PacMan");
-
-    // Print One Player
-    tft.setTextColor(0x0000, 0xFFFF);
-    tft.setCursor(34, 90);
-    tft.setTextSize(1);
-    tft.print("One Player");
+    // Select One Player
+    mainWidgets[1].selected = true;
+    mainWidgets[2].selected = false;
+    mainWidgets[3].selected = false;
+    labelResume("Resume"); // a save may have been made since it said there was none
+    showWidgets(mainWidgets, NUM_MAIN_WIDGETS);
+}
 
-    // Print Custom
-    tft.setCursor(46, 102);
-    tft.setTextColor(0xFFFF, 0x0000);
-    tft.print("Custom");
+// Draws rows of the view (0 is its top row) from the map's tile map in flash, or from the SD card if the map has none
+void drawMapRows(uint16_t firstRow, uint16_t rows) {
+    SPI_STATS_SCOPE("drawMapRows");
+#ifdef LINK_SIM
+    // The display board has the map, only which rows to draw is sent
+    uint16_t call[5] = {menu.map, firstRow, rows, (uint16_t) cameraX, (uint16_t) cameraY};
+    lcd_link_call(LINK_MAP_ROWS, (uint8_t*) call, sizeof(call));
+    return;
+#endif
+    LCD_LIST_FLUSH(tft); // Map rows are pushed at once, what came before them goes first
+    if (Map.tiles != NULL) {
+        lcd_tiles_draw(Map.tiles, &tft, cameraX, cameraY + firstRow, 0, MAP_TOP + firstRow, viewCollums(), rows);
+    }
+    else {
+        startStorage();
+        lcd_image_draw(Map.image, &tft, cameraX, cameraY + firstRow, 0, MAP_TOP + firstRow, viewCollums(), rows);
+    }
 }
 
 // Draws PacMan Sprite Centered at xCoordinate/2, yCoordinate/2 with specified color
 void drawPacMan(int16_t xCoordinate, int16_t yCoordinate, int color) {
+    SPI_STATS_SCOPE("drawPacMan");
+    if (headless || !inView(xCoordinate, yCoordinate)) {
+        return; // nothing is drawn while simulating, or outside the view
+    }
+    xCoordinate -= 2 * cameraX; // map to screen coordinates
+    yCoordinate -= 2 * cameraY;
     drawCircle(xCoordinate, yCoordinate, color); // Draw Circle
     int16_t squareX, squareY;
     // If moving in y direction
@@ -698,6 +1605,25 @@ void drawPacMan(int16_t xCoordinate, int16_t yCoordinate, int color) {
     }
 }
 
+// Packs the joystick into 4 bits for recording (horizontal in bits 0-1, vertical in bits 2-3)
+// Each direction is 0 for centre, 1 for left/up and 2 for right/down, which is all moveX and moveY use
+uint8_t encodeInput(int vert, int horiz) {
+    uint8_t input = 0;
+    if (abs(horiz - JOY_CENTRE) > JOY_DEADZONE) {
+        input |= (horiz - JOY_CENTRE > 0) ? 2 : 1;
+    }
+    if (abs(vert - JOY_CENTRE) > JOY_DEADZONE) {
+        input |= ((vert - JOY_CENTRE > 0) ? 2 : 1) << 2;
+    }
+    return input;
+}
+
+// Draws the whole view at the camera position, without sprites
+void drawView() {
+    drawMapRows(0, viewRows());
+    drawEatenDots();
+}
+
 // Evaluates which directions a random sprite (ghost) can move
 void evaluateDirections(int* up, int* down, int* left, int* right, sprite* Object) {
   // Moving in X direciton
@@ -736,13 +1662,14 @@ void evaluateDirections(int* up, int* down, int* left, int* right, sprite* Objec
   }
 }
 
-// Delays refreshing of screen based on framerate
-int frameDelay(int frameRate, int Time) {
-    int t = millis(); // Current time
-    if (t - Time < frameRate) {
-        delay(frameRate - (t - Time));
+// Ends the flight recorder's frame with the sprite positions (FLIGHT_RECORDER)
+void flightFrameEnd() {
+    int16_t sprites[2 * FLIGHT_SPRITES] = {PacMan.cursorX, PacMan.cursorY};
+    for (n = 0; n < menu.numOfGhosts; n++) {
+        sprites[2 + 2 * n] = (*(GhostPointer + n)).cursorX;
+        sprites[3 + 2 * n] = (*(GhostPointer + n)).cursorY;
     }
-    return millis(); // return time for next run of frameDelay
+    flight_frame_end(stateHash, sprites, FLIGHT_SPRITES);
 }
 
 // Generates 1s and 0s in dot arrays, with 1s indicating points/full and 0s indication empty
@@ -795,6 +1722,18 @@ void generateDots() {
     generateSpecialDots(); // generate big dots
 }
 
+// Generates the coordinate to dot space lookups used by dotIndexX and dotIndexY (all dot spaces are on odd coordinates)
+void generateDotIndex() {
+    memset(Map.xDotIndex, NO_DOT, (*(Map.locationOfXDots + Map.numOfXDotsPerRow - 1) - *Map.locationOfXDots) / 2 + 1);
+    for (i = 0; i < Map.numOfXDotsPerRow; i++) {
+        *(Map.xDotIndex + (*(Map.locationOfXDots + i) - *Map.locationOfXDots) / 2) = i;
+    }
+    memset(Map.yDotIndex, NO_DOT, (*(Map.locationOfYDots + Map.numOfYDotsPerCollum - 1) - *Map.locationOfYDots) / 2 + 1);
+    for (i = 0; i < Map.numOfYDotsPerCollum; i++) {
+        *(Map.yDotIndex + (*(Map.locationOfYDots + i) - *Map.locationOfYDots) / 2) = i;
+    }
+}
+
 // Generates areas with no dots that should have dots (tunnels) based on map specifications
 void generateNoDots() {
     // Loop runs through each range of dots with amount specified as first element in array
@@ -858,6 +1797,129 @@ void getConstraints(sprite* Object) {
     }
 }
 
+// Adds size bytes starting at start to a 32 bit FNV-1a hash
+uint32_t hashBytes(uint32_t hash, void* start, uint16_t size) {
+    uint8_t* bytes = (uint8_t*) start;
+    for (uint16_t byte = 0; byte < size; byte++) {
+        hash = (hash ^ *(bytes + byte)) * 16777619UL;
+    }
+    return hash;
+}
+
+// Runs background work in the time the current mode doesn't need
+void idle() {
+    startStorage(); // The SD card starts once the main menu is up, while the player looks at it
+    TRACE_IDLE(); // Writes the trace out once its buffer fills up
+    FLIGHT_IDLE(); // Writes the last frames out after an overrun or a death
+    LCD_LIST_IDLE(tft); // Draws a few fills of the last frame while waiting for the next
+#ifdef LINK_SIM
+    lcd_link_flush(); // Sends what the last frame drew to the display board
+#endif
+}
+
+// True when a sprite centered at xCoordinate/2, yCoordinate/2 on the map is inside the rows of the view
+bool inView(int16_t xCoordinate, int16_t yCoordinate) {
+    int16_t y = yCoordinate/2 - cameraY;
+    return y - 2 >= MAP_TOP && y + 3 < MAP_TOP + (int16_t) viewRows();
+}
+
+// Relabels the Resume option of the main menu, centred like the other options, and marks it for redrawing
+void labelResume(const char* text) {
+    mainWidgets[3].text = text;
+    mainWidgets[3].w = 6 * strlen(text);
+    mainWidgets[3].x = 64 - mainWidgets[3].w / 2;
+    mainWidgets[3].dirty = true;
+}
+
+// Limits a held joystick in the menus to one cursor move every MENU_REPEAT_MILLIS, a fresh push moves it right away
+void limitMenuRepeat(joy_event_t* joy, int joyDeadZone) {
+    if (abs((*joy).vert - JOY_CENTRE) <= joyDeadZone && abs((*joy).horiz - JOY_CENTRE) <= joyDeadZone) {
+        menuJoyHeld = false;
+    }
+    else if (menuJoyHeld && millis() - menuMoveTime < MENU_REPEAT_MILLIS) {
+        (*joy).vert = JOY_CENTRE;
+        (*joy).horiz = JOY_CENTRE;
+    }
+    else {
+        menuJoyHeld = true;
+        menuMoveTime = millis();
+    }
+}
+
+// Runs a call sent by the game board on the display board (LINK_RENDER)
+void linkCall(uint8_t id, uint8_t* data, uint8_t len) {
+    if (id == LINK_MAP_ROWS && len == 5 * sizeof(uint16_t)) {
+        uint16_t* call = (uint16_t*) data;
+        bool moved = ((int16_t) call[3] != cameraX || (int16_t) call[4] != cameraY);
+        if (call[0] < 1 || call[0] > sizeof(maps) / sizeof(maps[0])) {
+            return; // no such map
+        }
+        Map = maps[call[0] - 1];
+        if ((uint32_t) call[1] + call[2] > viewRows()) {
+            return; // rows below the view
+        }
+        cameraX = call[3];
+        cameraY = call[4];
+        drawMapRows(call[1], call[2]);
+        // Sprites the view moved under are composed again with the next sprites
+        if (moved) {
+            markSprite(PacMan.cursorX, PacMan.cursorY, pacManShape);
+            for (uint8_t ghost = 0; ghost < menu.numOfGhosts; ghost++) {
+                markSprite((*(GhostPointer + ghost)).cursorX, (*(GhostPointer + ghost)).cursorY, ghostShape);
+            }
+        }
+    }
+    else if (id == LINK_SPRITES && len >= 2) {
+        bool open = data[0];
+        uint8_t numOfGhosts = min(data[1], 4);
+        if (len < 2 + (1 + numOfGhosts) * LINK_SPRITE_BYTES) {
+            return;
+        }
+        // Changed sprites are marked at the old and new position, like updateCursor, then composed once
+        for (uint8_t slot = 0; slot <= numOfGhosts; slot++) {
+            uint8_t* entry = data + 2 + slot * LINK_SPRITE_BYTES;
+            sprite* Object = (slot == 0) ? &PacMan : GhostPointer + slot - 1;
+            uint8_t* shape = (slot == 0) ? pacManShape : ghostShape;
+            int16_t cursorX = entry[0] | (entry[1] << 8);
+            int16_t cursorY = entry[2] | (entry[3] << 8);
+            if (cursorX != (*Object).cursorX || cursorY != (*Object).cursorY || (int8_t) entry[4] != (*Object).delta
+                || (entry[5] & 1) != (*Object).moveX || (slot == 0 && open != pacManOpen)) {
+                markSprite((*Object).cursorX, (*Object).cursorY, shape);
+                markSprite(cursorX, cursorY, shape);
+            }
+            (*Object).cursorX = cursorX;
+            (*Object).cursorY = cursorY;
+            (*Object).delta = (int8_t) entry[4];
+            (*Object).moveX = entry[5] & 1;
+            (*Object).moveY = (entry[5] >> 1) & 1;
+            (*Object).color = entry[6] | (entry[7] << 8);
+        }
+        pacManOpen = open;
+        menu.numOfGhosts = numOfGhosts;
+        lcd_compose_draw(&tft, composeRow);
+    }
+}
+
+// Sends the sprites to the display board to compose (LINK_SIM), in place of markSprite and lcd_compose_draw
+void linkSprites() {
+    uint8_t call[2 + 5 * LINK_SPRITE_BYTES];
+    call[0] = pacManOpen;
+    call[1] = menu.numOfGhosts;
+    for (uint8_t slot = 0; slot <= menu.numOfGhosts; slot++) {
+        uint8_t* entry = call + 2 + slot * LINK_SPRITE_BYTES;
+        sprite* Object = (slot == 0) ? &PacMan : GhostPointer + slot - 1;
+        entry[0] = (*Object).cursorX;
+        entry[1] = (*Object).cursorX >> 8;
+        entry[2] = (*Object).cursorY;
+        entry[3] = (*Object).cursorY >> 8;
+        entry[4] = (*Object).delta;
+        entry[5] = (*Object).moveX | ((*Object).moveY << 1);
+        entry[6] = (*Object).color;
+        entry[7] = (*Object).color >> 8;
+    }
+    lcd_link_call(LINK_SPRITES, call, 2 + (1 + menu.numOfGhosts) * LINK_SPRITE_BYTES);
+}
+
 // Draws all ghosts to the screen at the beggining of level
 void loadGhosts() {
     // Loops through all ghosts
@@ -866,10 +1928,13 @@ void loadGhosts() {
     }
 }
 
-// Draws the specified created map to the screen
-void loadMap() {
-    tft.fillScreen(ST7735_BLACK); // init black
-    lcd_image_draw(Map.image, &tft, 0, 0, 0, 9, 128, 142); // draw map
+// Starts drawing the created map, the score and lives are drawn now and the map image a few rows per frame by updateTransition
+void loadLevel() {
+    SPI_STATS_SCOPE("loadLevel");
+    screenWidgets = NULL; // menu widgets are gone
+    // Clears the score and lives bands, the map image covers the rest of the screen
+    tft.fillRect(0, 0, 128, 9, ST7735_BLACK);
+    tft.fillRect(0, 151, 128, 9, ST7735_BLACK);
 
     // Print current score
     tft.setCursor(12, 0);
@@ -886,6 +1951,29 @@ void loadMap() {
         tft.fillRect(15 + (8 * i), 154, 3, 2, ST7735_BLACK);
     }
 
+    loadRow = 0;
+}
+
+// Draws the specified created map to the screen all at once
+void loadMap() {
+    loadLevel();
+    drawMapRows(0, viewRows()); // draw map
+    loadRow = viewRows();
+}
+
+// Loads a snapshot from the SD card, returns false if it is missing, from a different version or of a map it can't hold
+bool loadSnapshot(const char* fileName, snapshot* Snapshot) {
+    if (!startStorage()) {
+        return false;
+    }
+    File file = SD.open(fileName);
+    if (!file) {
+        return false;
+    }
+    bool loaded = file.read((uint8_t*) Snapshot, sizeof(snapshot)) == sizeof(snapshot);
+    file.close();
+    return loaded && (*Snapshot).version == SNAPSHOT_VERSION && (*Snapshot).size == sizeof(snapshot)
+           && snapshotFits((*Snapshot).menu.map);
 }
 
 // Draws PacMan to the screen at the beggining of the level
@@ -893,6 +1981,56 @@ void loadPacMan() {
     drawPacMan(PacMan.joyX, PacMan.joyY, PacMan.color);
 }
 
+// Exchanges the frame's input with the other board in a two player game, false until the other board's input is in
+bool lockstepFrame() {
+    if (!lockstep_active()) {
+        return true;
+    }
+    // The host sends its state once the boards have gone apart, the guest takes it over
+    if (lockstep_desynced() && captureSnapshot(&savedGame)) {
+        lockstep_resync();
+    }
+    if (lockstep_resynced() && snapshotFits(savedGame.menu.map)) {
+        restoreSnapshot(&savedGame);
+    }
+    joy_event_t joy;
+    joy_read(&joy, JOY_DEADZONE);
+    return lockstep_input(encodeInput(joy.vert, joy.horiz), stateHash, &pacManInput, &ghostInput);
+}
+
+// Starts a two player game with the other board when built with LOCKSTEP, unless the other board started it
+void lockstepStart() {
+    if (!lockstep_guest()) {
+        lockstep_host(customMenuArray, 5);
+    }
+}
+
+// Marks the screen area of a sprite centered at xCoordinate/2, yCoordinate/2 for the compositor to redraw
+void markSprite(int16_t xCoordinate, int16_t yCoordinate, uint8_t* shape) {
+#ifdef LINK_SIM
+    return; // the display board marks the sprites itself from linkSprites
+#endif
+    if (headless) {
+        return; // nothing is drawn while simulating
+    }
+    for (uint8_t row = 0; row < 6; row++) {
+        // Every shape row is one run of columns
+        uint8_t first = 0;
+        uint8_t last = 5;
+        while (!(shape[row] & (1 << first))) {
+            first++;
+        }
+        while (!(shape[row] & (1 << last))) {
+            last--;
+        }
+        int16_t y = yCoordinate/2 - cameraY - 2 + row;
+        // Rows outside the view belong to the score and lives
+        if (y >= MAP_TOP && y < MAP_TOP + (int16_t) viewRows()) {
+            lcd_compose_add(xCoordinate/2 - cameraX - 2 + first, y, last - first + 1);
+        }
+    }
+}
+
 // Function that updates the joyX of the sprite
 void moveX(int horiz, sprite* Object) {
   // If (There is a request to move in the x direction and sprite is in a row OR it's already moving in the x direction)
@@ -953,25 +2091,20 @@ int randomGenerator(int upNumber, int downNumber, int leftNumber, int rightNumbe
     int randomArray[randomIndex]; // Stores random numbers
     // Stores value 2 upNumber times in randomArray
     for (i = 0; i < upNumber; ++i) {
-        randomSeed(analogRead(2));
-        randomArray[i] = random(2,3);
+        randomArray[i] = 2;
     }
     // Stores value 1 rightNumber times in randomArray
     for (i = 0; i < rightNumber; ++i) {
-        randomSeed(analogRead(2));
-        randomArray[i + upNumber] = random(1,2);
+        randomArray[i + upNumber] = 1;
     }
     // Stores value -2 downNumber times in randomArray
     for (i = 0; i < downNumber; ++i) {
-        randomSeed(analogRead(2));
-        randomArray[i + upNumber + rightNumber] = random(-2,-1);
+        randomArray[i + upNumber + rightNumber] = -2;
     }
     // Stores value -1 leftNumber times in randomArray
     for (i = 0; i < leftNumber; ++i) {
-        randomSeed(analogRead(2));
-        randomArray[i + upNumber + rightNumber + downNumber] = random(-1,0);
+        randomArray[i + upNumber + rightNumber + downNumber] = -1;
     }
-    randomSeed(analogRead(2));
     // Returns one of the values randomly chosen from the array
     return randomArray[random(0,randomIndex)];
 }
@@ -1009,21 +2142,18 @@ int randGhost(sprite* Object) {
 // if the dot is read or not and return its value
 uint8_t readDotsX(sprite* Object) {
     // x positions of prev and next collum intersections
-    uint8_t prevIndex = *(Map.locationOfCollumXDots + (*Object).prevCollum);
-    uint8_t nextIndex = *(Map.locationOfCollumXDots + (*Object).nextCollum);
+    uint16_t prevIndex = *(Map.locationOfCollumXDots + (*Object).prevCollum);
+    uint16_t nextIndex = *(Map.locationOfCollumXDots + (*Object).nextCollum);
+    uint8_t index = dotIndexX((*Object).joyX); // dot position the sprite is on
 
     uint8_t value = 0; // dot value
-    // Loops through each dot position between intersections
-    for (i = prevIndex; i <= nextIndex; i++) {
-        // If at a dot positon...
-        if ((*Object).joyX == *(Map.locationOfXDots + i)) {
-            // Value equals the equivalent dot position in the xDots array
-            value = *(Map.xDots + i + ((*Object).prevRow * Map.numOfXDotsPerRow));
-            if (value != 0) {
-                // Updates that the dot has been read and makes it 0
-                *(Map.xDots + i + ((*Object).prevRow * Map.numOfXDotsPerRow)) = 0;
-            }
-            break;
+    // If at a dot positon between the intersections (NO_DOT is always past nextIndex)...
+    if (index >= prevIndex && index <= nextIndex) {
+        // Value equals the equivalent dot position in the xDots array
+        value = *(Map.xDots + index + ((*Object).prevRow * Map.numOfXDotsPerRow));
+        if (value != 0) {
+            // Updates that the dot has been read and makes it 0
+            *(Map.xDots + index + ((*Object).prevRow * Map.numOfXDotsPerRow)) = 0;
         }
     }
     return value;
@@ -1041,12 +2171,10 @@ uint8_t readDotsXY (sprite* Object) {
             break;
         }
     }
-    // For loop that determines which collum the dot is on
-    for (i = 0; i < Map.numOfXDotsPerRow; i++) {
-        if ((*Object).joyX == *(Map.locationOfXDots + i)) {
-            indexTwo = i;
-            break;
-        }
+    // Determines which collum the dot is on
+    indexTwo = dotIndexX((*Object).joyX);
+    if (indexTwo == NO_DOT) {
+        return 0;
     }
     // Computes the value (stored in xDots) at the given intersection
     value = *(Map.xDots + indexTwo + (indexOne * Map.numOfXDotsPerRow));
@@ -1061,31 +2189,106 @@ uint8_t readDotsXY (sprite* Object) {
 // if the dot is read or not and return its value
 uint8_t readDotsY(sprite* Object) {
     // y positions of prev and next row intersections
-    uint8_t prevIndex = *(Map.locationOfRowYDots + (*Object).prevRow);
-    uint8_t nextIndex = *(Map.locationOfRowYDots + (*Object).nextRow);
+    uint16_t prevIndex = *(Map.locationOfRowYDots + (*Object).prevRow);
+    uint16_t nextIndex = *(Map.locationOfRowYDots + (*Object).nextRow);
+    uint8_t index = dotIndexY((*Object).joyY); // dot position the sprite is on
 
     uint8_t value = 0; // dot value
-    // Loops through each dot position between intersectinos
-    for (i = prevIndex; i <= nextIndex; i++) {
-        // if at a dot position...
-        if ((*Object).joyY == *(Map.locationOfYDots + i)) {
-            // Value eqals the equivalent dot position in the yDots array
-            value = *(Map.yDots + i + ((*Object).prevCollum * Map.numOfYDotsPerCollum));
-            if (value != 0) {
-                // Update that the dot has been read and make it 0
-                *(Map.yDots + i + ((*Object).prevCollum * Map.numOfYDotsPerCollum)) = 0;
-            }
-            break;
+    // if at a dot position between the intersections (NO_DOT is always past nextIndex)...
+    if (index >= prevIndex && index <= nextIndex) {
+        // Value eqals the equivalent dot position in the yDots array
+        value = *(Map.yDots + index + ((*Object).prevCollum * Map.numOfYDotsPerCollum));
+        if (value != 0) {
+            // Update that the dot has been read and make it 0
+            *(Map.yDots + index + ((*Object).prevCollum * Map.numOfYDotsPerCollum)) = 0;
         }
     }
     return value;
 }
 
+// Resets the movement values for potential ghosts (all start moving left)
+void resetGhostMoves() {
+    for (i = 0; i < 8; i++) {
+        move[i] = -2000;
+    }
+}
+
+// Restores the game state from a snapshot and redraws the level as it was
+void restoreSnapshot(snapshot* Snapshot) {
+    uint16_t dot;
+    uint8_t value;
+
+    menu = (*Snapshot).menu;
+    customMenuArray[0] = menu.color;
+    customMenuArray[1] = menu.numOfGhosts;
+    customMenuArray[2] = menu.difficulty;
+    customMenuArray[3] = menu.lives;
+    customMenuArray[4] = menu.map;
+    PacMan = (*Snapshot).pacMan;
+    memcpy(Ghosts, (*Snapshot).ghosts, sizeof(Ghosts));
+    memcpy(move, (*Snapshot).move, sizeof(move));
+    score = (*Snapshot).score;
+    prevScore = score;
+    ghostScore = (*Snapshot).ghostScore;
+    totalScore = score + ghostScore;
+    oneUpScore = (*Snapshot).oneUpScore;
+    resetScore = (*Snapshot).resetScore;
+    movement = (*Snapshot).movement;
+    randomSeed(FLIGHT_SEED((*Snapshot).seed));
+
+    createMap(); // Map and full dots
+    centreCamera();
+    loadMap(); // Map image, score and lives
+
+    // Unpacks the dots
+    for (dot = 0; dot < Map.numOfXDots + Map.numOfYDots; dot++) {
+        value = ((*Snapshot).dots[dot / 4] >> (2 * (dot % 4))) & 3;
+        // 2 is a special dot
+        if (value == 2) {
+            value = 5;
+        }
+        if (dot < Map.numOfXDots) {
+            *(Map.xDots + dot) = value;
+        }
+        else {
+            *(Map.yDots + dot - Map.numOfXDots) = value;
+        }
+    }
+    drawEatenDots(); // erases the eaten dots drawn on the map image
+
+    loadPacMan();
+    loadGhosts();
+}
+
+// Starts recording or replaying a game when built with REPLAY_RECORD or REPLAY_PLAY
+void replayStart() {
+#if defined(REPLAY_RECORD) || defined(REPLAY_PLAY)
+    startStorage();
+#endif
+#if defined(REPLAY_RECORD)
+    replay_record(REPLAY_FILE);
+#elif defined(REPLAY_PLAY)
+    replay_play(REPLAY_FILE);
+#endif
+    replay_settings(customMenuArray, 5); // records, or replaces with the recorded, custom menu values
+}
+
 // Fucntions used to reset certain values when changing menus, dying, finishing the level or leaving a game
 void reset() {
+    TRACE_SCOPE_VALUE("reset", mode);
+    SRAM_REPORT("reset"); // SRAM left after everything up to the last transition
+    // Joystick changes lost since the last transition, the game went too long without reading the joystick
+    if (joy_overflows() != joyDropped) {
+        Serial.print("Joystick queue full, events dropped: ");
+        Serial.println(joy_overflows() - joyDropped);
+        joyDropped = joy_overflows();
+    }
     switch (mode) {
         case 1:
+            replay_end(stateHash); // finish recording or replaying the game that just ended
+            lockstep_end(); // both boards reach game over on the same frame
             drawMain(); // draw main menu
+            BOOT_MARK("menu"); // the first main menu after reset is the end of start-up
 
             // Reset the joystick and cursor
             mainJoyY = 0;
@@ -1110,7 +2313,8 @@ void reset() {
             oneUpScore = 3000;
             resetScore = 0;
 
-            mode++;
+            // Frame capture replays the game once per band of screen rows, like choosing One Player again
+            mode = LCD_CAPTURE_NEXT_PASS() ? 5 : mode + 1;
             break;
         case 3:
             drawCustom(); // draw custom menu
@@ -1122,44 +2326,50 @@ void reset() {
             mode++;
             break;
         case 5:
+            // Resuming a saved game, skip the new level
+            if (resumeGame) {
+                resumeGame = false;
+                restoreSnapshot(&savedGame);
+                startPending = true;
+                playTime = millis() + LEVEL_START_MILLIS;
+                mode += 2;
+                break;
+            }
+            // First level of a game
+            if (resetScore == 0) {
+                replayStart();
+                lockstepStart();
+                LCD_CAPTURE_START();
+            }
+            // Seed ghost movement from the potentiometer on A2 (sampled with the joystick), in a two player game the host's seed
+            randomSeed(FLIGHT_SEED(lockstep_seed(replay_seed(joy_noise()))));
             updateMenuStruct(); // Update struct based on custom menu input
             createMap(); // create map struct
             createPacMan(); // create pacman struct
             createGhosts(); // create ghost struct
-            loadMap(); // Draw and load map elements
-            loadPacMan(); // Draw and load PacMan elements
-            loadGhosts(); // Draw and load Ghost elements
+            centreCamera(); // view around PacMan, the map is drawn with the level
+            loadLevel(); // Draw score and lives, the map and sprites are drawn over the next frames
             movement = 0; // Update movement (PacMan open and close mouth variable)
             resetScore += 2560; // Resets level at this score
-            // Resets the movement values for potential ghosts
-            move[0] = -2000;
-            move[1] = -2000;
-            move[2] = -2000;
-            move[3] = -2000;
-            move[4] = -2000;
-            move[5] = -2000;
-            move[6] = -2000;
-            move[7] = -2000;
+            resetGhostMoves(); // Resets the movement values for potential ghosts
 
+            // Play starts LEVEL_START_MILLIS from now, whatever the map takes to draw
+            startPending = true;
+            playTime = millis() + LEVEL_START_MILLIS;
             mode += 2;
-            delay(2000);
             break;
         case 6:
             createPacMan(); // create pacman struct
             createGhosts(); // create ghosts structs
+            // Moves the view back to PacMan's start
+            if (centreCamera()) {
+                drawView();
+            }
             loadPacMan(); // load and draw pacman
             loadGhosts(); // load and draw ghosts
             movement = 0; // Update movement (PacMan open and close mouth variable)
 
-            // Resets the movement values for potential ghosts
-            move[0] = -2000;
-            move[1] = -2000;
-            move[2] = -2000;
-            move[3] = -2000;
-            move[4] = -2000;
-            move[5] = -2000;
-            move[6] = -2000;
-            move[7] = -2000;
+            resetGhostMoves(); // Resets the movement values for potential ghosts
 
             // Redraw score
             tft.setCursor(12, 0);
@@ -1176,25 +2386,46 @@ void reset() {
                 drawCircle(29 + (16 * i), 309, PacMan.color);
                 tft.fillRect(15 + (8 * i), 154, 3, 2, ST7735_BLACK);
             }
+            startPending = true;
+            playTime = millis() + LEVEL_START_MILLIS;
             mode += 1;
-            delay(2000);
             break;
     }
 }
 
+// Writes a snapshot to the SD card, replacing the file if it exists
+bool saveSnapshot(const char* fileName, snapshot* Snapshot) {
+    if (!startStorage()) {
+        return false;
+    }
+    if (SD.exists(fileName)) {
+        SD.remove(fileName); // opening for write appends
+    }
+    File file = SD.open(fileName, FILE_WRITE);
+    if (!file) {
+        return false;
+    }
+    bool saved = file.write((uint8_t*) Snapshot, sizeof(snapshot)) == sizeof(snapshot);
+    file.close();
+    return saved;
+}
+
 // Scans everything in main game
 void scan() {
-    scanScore();
-    scanPacMan();
-    scanGhosts();
+    TRACE_CALL(scanScore());
+    TRACE_CALL(scanPacMan());
+    TRACE_CALL(scanGhosts());
 }
 
 // Scans everything in custom menu
 void scanCustom() {
-    int vert = analogRead(JOY_VERT_ANALOG);
-    int horiz = analogRead(JOY_HORIZ_ANALOG);
-    int select = digitalRead(JOY_SEL);
     int joyDeadZone = 500;
+    joy_event_t joy;
+    joy_read(&joy, joyDeadZone); // joystick events since the last scan
+    limitMenuRepeat(&joy, joyDeadZone);
+    int vert = joy.vert;
+    int horiz = joy.horiz;
+    int select = joy.select;
     int customDelta = 0;
     uint8_t upperConstraint; // How high you can make the custom values
 
@@ -1248,7 +2479,13 @@ void scanGhosts() {
     for (j = 0; j < menu.numOfGhosts; j++) {
         // If ghost is at an intersection
         if (((*(GhostPointer + j)).moveX && (*(GhostPointer + j)).modeY) || ((*(GhostPointer + j)).moveY && (*(GhostPointer + j)).modeX)) {
-            *(move + j) = randGhost((GhostPointer + j)); // determine which way to move
+            // The first ghost goes where the guest steers it in a two player game
+            if (j == 0 && lockstep_active()) {
+                *(move + j) = steerGhost(ghostInput, GhostPointer);
+            }
+            else {
+                *(move + j) = randGhost((GhostPointer + j)); // determine which way to move
+            }
         }
         // If not, use previous move direction
         else {
@@ -1270,9 +2507,12 @@ void scanGhosts() {
 // Scans everything in main menu
 void scanMain() {
 
-    int vert = analogRead(JOY_VERT_ANALOG);
-    int select = digitalRead(JOY_SEL);
     int joyDeadZone = 300;
+    joy_event_t joy;
+    joy_read(&joy, joyDeadZone); // joystick events since the last scan
+    limitMenuRepeat(&joy, joyDeadZone);
+    int vert = joy.vert;
+    int select = joy.select;
     int mainDelta = 0;
 
     // If request to move in y direction
@@ -1282,21 +2522,55 @@ void scanMain() {
         else {
             mainDelta = -1; // move up
         }
-            mainJoyY = constrain(mainJoyY + mainDelta, 0, 1);
+            mainJoyY = constrain(mainJoyY + mainDelta, 0, 2);
     }
     // if pushed down
     if (select == 0) {
         if (mainJoyY == 0)
             mode = 5;
-        else
+        else if (mainJoyY == 1)
             mode = 3;
+        // Resume the saved game if there is one, otherwise say there is none
+        else if (loadSnapshot(SAVE_FILE, &savedGame)) {
+            resumeGame = true;
+            mode = 5;
         }
+        else {
+            labelResume("No Save");
+        }
+    }
 }
 
 // scan everything for pacMan
 void scanPacMan() {
-    int vert = analogRead(JOY_VERT_ANALOG);
-    int horiz = analogRead(JOY_HORIZ_ANALOG);
+    uint8_t input;
+    // Headless games take their input from core_step, or the simulator steers PacMan itself
+    if (headless) {
+        input = (coreInputs != NULL) ? *coreInputs++ : simulatedInput();
+    }
+    else if (lockstep_active()) {
+        input = pacManInput; // the host's input, exchanged by lockstepFrame
+    }
+    else {
+        joy_event_t joy;
+        joy_read(&joy, JOY_DEADZONE); // joystick events since the last frame
+        // Records the input, or replaces it with the recorded input
+        input = replay_input(encodeInput(joy.vert, joy.horiz), stateHash);
+
+        // Saves the game when select is pressed (not while recording or replaying, saving reseeds the ghosts)
+        if (joy.select == 0 && !saveHeld && !replay_active()) {
+            if (!captureSnapshot(&savedGame)) {
+                Serial.println("Map too big to save");
+            }
+            else if (saveSnapshot(SAVE_FILE, &savedGame)) {
+                Serial.println("Game saved");
+            }
+        }
+        saveHeld = (joy.select == 0);
+    }
+    FLIGHT_INPUT(input);
+    int vert = decodeInput(input >> 2);
+    int horiz = decodeInput(input & 3);
     // If moving in y direciton
     if (PacMan.moveY) {
         moveX(horiz, &PacMan); // check and update x direction first
@@ -1346,42 +2620,270 @@ void scanScore() {
     }
 }
 
+// Clears the previous screen and draws the given menu widgets in full
+void showWidgets(lcd_widget_t* widgets, uint8_t count) {
+    SPI_STATS_SCOPE("showWidgets");
+    // Only the previous menu's widgets need erasing, anything else needs a full clear
+    if (screenWidgets == NULL) {
+        tft.fillScreen(ST7735_BLACK);
+    }
+    else {
+        lcd_widgets_clear(screenWidgets, numOfScreenWidgets, &tft, ST7735_BLACK);
+    }
+    for (i = 0; i < count; i++) {
+        (*(widgets + i)).dirty = true;
+    }
+    screenWidgets = widgets;
+    numOfScreenWidgets = count;
+    lcd_widgets_draw(widgets, count, &tft);
+}
+
+// Runs SIM_GAMES games at every difficulty without drawing and prints how they went
+void simulate() {
+    simStats stats;
+    Serial.println("Simulating...");
+    for (uint8_t difficulty = 1; difficulty <= 4; difficulty++) {
+        memset(&stats, 0, sizeof(stats));
+        for (uint16_t game = 0; game < SIM_GAMES; game++) {
+            menu.difficulty = difficulty;
+            simulateGame(SIM_SEED + game, &stats);
+        }
+        Serial.print("Difficulty ");
+        Serial.print(difficulty);
+        Serial.print(": ");
+        Serial.print(stats.ticks / stats.games);
+        Serial.print(" frames survived, ");
+        Serial.print(100.0 * stats.pacManScore / max(stats.pacManScore + stats.ghostScore, 1UL), 1);
+        Serial.print("% of points to PacMan, ");
+        Serial.print((double) stats.deaths / (stats.levels + stats.games), 2); // every game ends during a level
+        Serial.println(" deaths per level");
+    }
+}
+
+// Plays one game without drawing (4 ghosts, 3 lives, current menu.difficulty) and adds it to stats
+void simulateGame(uint32_t seed, simStats* Stats) {
+    core_config config = {4, menu.difficulty, 3, 1};
+    core_observation observation;
+
+    core_create(&config, &observation);
+    core_reset(seed);
+    core_step(NULL, SIM_MAX_TICKS);
+
+    (*Stats).games++;
+    (*Stats).ticks += observation.ticks;
+    (*Stats).levels += observation.levels;
+    (*Stats).deaths += observation.deaths;
+    (*Stats).pacManScore += observation.score;
+    (*Stats).ghostScore += observation.ghostScore;
+    freezeMode = 0;
+}
+
+// Steers PacMan in the simulator: at a turn he takes the open direction that keeps him furthest from the nearest ghost
+uint8_t simulatedInput() {
+    // Only intersections and walls need a decision, otherwise he keeps going
+    if (!(PacMan.modeX && PacMan.modeY)) {
+        return 0;
+    }
+    // Directions as encodeInput would give them: right, left, down, up
+    uint8_t inputs[4] = {2, 1, 2 << 2, 1 << 2};
+    int16_t stepX[4] = {8, -8, 0, 0};
+    int16_t stepY[4] = {0, 0, 8, -8};
+    bool open[4] = {PacMan.upperXConstraint != PacMan.joyX, PacMan.lowerXConstraint != PacMan.joyX,
+                    PacMan.upperYConstraint != PacMan.joyY, PacMan.lowerYConstraint != PacMan.joyY};
+    uint8_t best = 0;
+    int16_t bestDistance = -1;
+
+    for (uint8_t direction = 0; direction < 4; direction++) {
+        if (!open[direction]) {
+            continue;
+        }
+        // Distance from the nearest ghost after taking a step this way, with a little randomness to break ties
+        int16_t distance = 0x7FFF;
+        for (n = 0; n < menu.numOfGhosts; n++) {
+            distance = min(distance, abs(PacMan.joyX + stepX[direction] - (*(GhostPointer + n)).joyX) +
+                                     abs(PacMan.joyY + stepY[direction] - (*(GhostPointer + n)).joyY));
+        }
+        distance += random(0, 16);
+        if (distance > bestDistance) {
+            bestDistance = distance;
+            best = inputs[direction];
+        }
+    }
+    return best;
+}
+
+// True if map (1 for the first) exists and a snapshot holds all of its dots
+bool snapshotFits(uint8_t map) {
+    if (map < 1 || map > sizeof(maps) / sizeof(maps[0])) {
+        return false;
+    }
+    return maps[map - 1].numOfXDots + maps[map - 1].numOfYDots <= SNAPSHOT_MAX_DOTS;
+}
+
+// Starts the SD card the first time anything needs it, true once it is ready (it is only tried once)
+bool startStorage() {
+    if (storageState == 0) {
+        Serial.print("Initializing SD card...");
+        if (SD.begin(SD_CS)) {
+            storageState = 1;
+            Serial.println("OK!");
+            TRACE_START(TRACE_FILE);
+            FLIGHT_START(FLIGHT_FILE, customMenuArray, 5, MILLIS_PER_FRAME);
+        }
+        else {
+            storageState = 2;
+            Serial.println("failed!");
+        }
+        BOOT_MARK("sd");
+        BOOT_REPORT();
+    }
+    return storageState == 1;
+}
+
+// Hashes (16 bit FNV-1a) the sprites, ghost moves and scores, used to check that a replay matches its recording
+uint16_t stateHash() {
+    uint32_t hash = 2166136261UL;
+    hash = hashBytes(hash, &PacMan, sizeof(sprite));
+    hash = hashBytes(hash, GhostPointer, menu.numOfGhosts * sizeof(sprite));
+    hash = hashBytes(hash, move, sizeof(move));
+    hash = hashBytes(hash, &score, sizeof(score));
+    hash = hashBytes(hash, &ghostScore, sizeof(ghostScore));
+    hash = hashBytes(hash, &movement, sizeof(movement));
+    return (uint16_t) (hash ^ (hash >> 16)); // fold to 16 bits
+}
+
+// Picks the way a ghost steered by the guest goes at an intersection, in the values randomGenerator returns
+int steerGhost(uint8_t input, sprite* Object) {
+    int up = 0;
+    int down = 0;
+    int left = 0;
+    int right = 0;
+    // Which ways are open, up and down as named by evaluateDirections
+    evaluateDirections(&up, &down, &left, &right, Object);
+    if ((input >> 2) == 2 && up) {
+        return 2;
+    }
+    if ((input >> 2) == 1 && down) {
+        return -2;
+    }
+    if ((input & 3) == 2 && right) {
+        return 1;
+    }
+    if ((input & 3) == 1 && left) {
+        return -1;
+    }
+    // Keeps going the same way if it can, otherwise the ghost picks its own way
+    if ((*Object).moveX && ((*Object).delta > 0 ? right : left)) {
+        return ((*Object).delta > 0) ? 1 : -1;
+    }
+    if ((*Object).moveY && ((*Object).delta > 0 ? up : down)) {
+        return ((*Object).delta > 0) ? 2 : -2;
+    }
+    return randGhost(Object);
+}
+
+// Scans and updates the custom menu
+void tickCustom() {
+    scanCustom(); // Scan joystick
+    updateCustom(); // Updates cursor and custom menu struct
+}
+
+// Runs a frame of the game, level loading, countdown and freezes run in place of the game
+void tickGame() {
+    TRACE_FRAME_BEGIN();
+    FLIGHT_FRAME_BEGIN();
+    if (updateTransition() && lockstepFrame()) {
+        FLIGHT_FRAME_PLAYED(); // Only played frames are recorded, as in replays
+        TRACE_CALL(scan());
+        FLIGHT_PHASE(FLIGHT_SCAN);
+        TRACE_CALL(update());
+        FLIGHT_PHASE(FLIGHT_UPDATE);
+        LCD_CAPTURE_FRAME_END(); // Writes or checks the captured rows of every LCD_CAPTURE_EVERY game frames
+        // PacMan died this frame
+        if (freezeMode == 6) {
+            FLIGHT_DUMP(FLIGHT_REASON_DEATH);
+        }
+#ifdef FLIGHT_RECORDER
+        flightFrameEnd();
+#endif
+    }
+    TRACE_FRAME_END();
+    SPI_STATS_FRAME_END(); // Prints the display traffic every SPI_STATS_FRAMES frames
+}
+
+// Scans and updates the main menu
+void tickMain() {
+    // The other board started a two player game, this board plays the first ghost
+    if (lockstep_joined(customMenuArray, 5)) {
+        mode = 5;
+        return;
+    }
+    scanMain(); //Scans joystick
+    updateMain(); // Updates menu screen
+}
+
 // Update everything
 void update() {
-    updateSprite(&PacMan);
-    updateSprite(GhostPointer);
-    updateScore();
-    updateLives();
-    updateGame();
+    TRACE_CALL(updateSprite(&PacMan));
+    TRACE_CALL(updateSprite(GhostPointer));
+    TRACE_CALL(updateCamera()); // Keeps PacMan in view
+#ifdef LINK_SIM
+    TRACE_CALL(linkSprites()); // The display board composes the sprites
+#else
+    LCD_LIST_FLUSH(tft); // Sprites are pushed at once too
+    TRACE_CALL(lcd_compose_draw(&tft, composeRow)); // Draws every part of the screen a sprite moved through, once
+#endif
+    TRACE_CALL(updateScore());
+    TRACE_CALL(updateLives());
+    TRACE_CALL(updateGame());
+}
+
+// Recentres the view on PacMan once he comes within CAMERA_MARGIN of its edge, on mazes bigger than the view
+void updateCamera() {
+    int16_t x = PacMan.cursorX/2 - cameraX;
+    int16_t y = PacMan.cursorY/2 - MAP_TOP - cameraY;
+    if (headless || (x >= CAMERA_MARGIN && x < (int16_t) viewCollums() - CAMERA_MARGIN
+                     && y >= CAMERA_MARGIN && y < (int16_t) viewRows() - CAMERA_MARGIN)) {
+        return;
+    }
+    // Nothing moves at the edge of the maze
+    if (!centreCamera()) {
+        return;
+    }
+    drawView();
+    markSprite(PacMan.cursorX, PacMan.cursorY, pacManShape);
+    for (uint8_t ghost = 0; ghost < menu.numOfGhosts; ghost++) {
+        markSprite((*(GhostPointer + ghost)).cursorX, (*(GhostPointer + ghost)).cursorY, ghostShape);
+    }
 }
 
 // Update constraint for x (walls)
 void updateConstraintsX(sprite* Object) {
   // Checks every potential intersection in row starting at the next right collum intersection
-  for (i = ((*Object).nextCollum + ((*Object).nextRow * Map.numOfRows)); i < Map.numOfCollums + ((*Object).nextRow * Map.numOfRows); ++i) {
+  for (i = ((*Object).nextCollum + ((*Object).nextRow * Map.numOfCollums)); i < Map.numOfCollums + ((*Object).nextRow * Map.numOfCollums); ++i) {
       // If i marks a right wall
       if (*(Map.xMovement + i) == 1) {
           // Upper x constraints equals the x coordinate of that wall
-          (*Object).upperXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfRows)));
+          (*Object).upperXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfCollums)));
           break;
       }
       // If there is free movement and it's reached the last collum intersection (marking a out of map tunnel)
-      else if (*(Map.xMovement + i) == 3 && i == Map.numOfCollums + ((*Object).nextRow * (Map.numOfRows)) - 1) {
+      else if (*(Map.xMovement + i) == 3 && i == Map.numOfCollums + ((*Object).nextRow * Map.numOfCollums) - 1) {
           // Wall is placed outside of map
           (*Object).upperXConstraint = *(Map.collums + Map.numOfCollums - 1) + 26;
           break;
       }
   }
   // Checks every potential intersection in row starting at the next left collum intersection
-  for (i = ((*Object).prevCollum + ((*Object).nextRow * Map.numOfRows)); i >= ((*Object).nextRow * Map.numOfRows); --i) {
+  for (i = ((*Object).prevCollum + ((*Object).nextRow * Map.numOfCollums)); i >= ((*Object).nextRow * Map.numOfCollums); --i) {
       // If i marks a left wall
       if (*(Map.xMovement + i) == 2) {
           // Lower x constraint equals the x coordinate of that wall
-          (*Object).lowerXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfRows)));
+          (*Object).lowerXConstraint = *(Map.collums + (i - ((*Object).nextRow * Map.numOfCollums)));
           break;
       }
       // If there is free movement and the first collum intersection is reached (marking a out of map tunnel)
-      else if (*(Map.xMovement + i) == 3 && i == ((*Object).nextRow * Map.numOfRows)) {
+      else if (*(Map.xMovement + i) == 3 && i == ((*Object).nextRow * Map.numOfCollums)) {
           // Wall is placed outside of map
           (*Object).lowerXConstraint = *Map.collums - 26;
           break;
@@ -1392,7 +2894,7 @@ void updateConstraintsX(sprite* Object) {
 // Update constraint for y (walls)
 void updateConstraintsY(sprite* Object) {
   // Checks every potential intersection in collum starting at the next right row intersection
-  for (i = ((*Object).nextRow + ((*Object).nextCollum * (Map.numOfCollums))); i < (Map.numOfRows + ((*Object).nextCollum * Map.numOfCollums)); ++i) {
+  for (i = ((*Object).nextRow + ((*Object).nextCollum * Map.numOfRows)); i < (Map.numOfRows + ((*Object).nextCollum * Map.numOfRows)); ++i) {
       // If i marks a top wall
       if (*(Map.yMovement + i) == 1) {
           // Upper y constraint equals the y coordinate of that wall
@@ -1400,22 +2902,22 @@ void updateConstraintsY(sprite* Object) {
           break;
       }
       // If there is free movement and the first row intersection is reached (marking a out of map tunnel)
-      else if (*(Map.yMovement + i) == 3 && i == Map.numOfRows + ((*Object).nextCollum * (Map.numOfCollums)) - 1) {
+      else if (*(Map.yMovement + i) == 3 && i == Map.numOfRows + ((*Object).nextCollum * Map.numOfRows) - 1) {
           // Wall is placed outside of map
           (*Object).upperYConstraint = *(Map.rows + Map.numOfRows - 1) + 26;
           break;
       }
   }
   // Checks every potential intersection in collum starting at the next left row intersection
-  for (i = ((*Object).prevRow + ((*Object).nextCollum * Map.numOfCollums)); i >= ((*Object).nextCollum * Map.numOfCollums); --i) {
+  for (i = ((*Object).prevRow + ((*Object).nextCollum * Map.numOfRows)); i >= ((*Object).nextCollum * Map.numOfRows); --i) {
       // If i marks a bottom wall
       if (*(Map.yMovement + i) == 2) {
           // Upper y constraint equals the y coordinate of that wall
-          (*Object).lowerYConstraint = *(Map.rows + (i - ((*Object).nextCollum * Map.numOfCollums)));
+          (*Object).lowerYConstraint = *(Map.rows + (i - ((*Object).nextCollum * Map.numOfRows)));
           break;
       }
       // If there is free movement and the last tow intersection is reached (amrking a out of map tunnel)
-      else if (*(Map.yMovement + i) == 3 && i == ((*Object).nextCollum * Map.numOfCollums)) {
+      else if (*(Map.yMovement + i) == 3 && i == ((*Object).nextCollum * Map.numOfRows)) {
           // Upper y constraint equals the y coordinate of that wall
           (*Object).lowerYConstraint = *Map.rows - 26;
           break;
@@ -1427,24 +2929,25 @@ void updateConstraintsY(sprite* Object) {
 void updateCursor(sprite* Object) {
     // If joyY or joyX does not equal cursor positions
     if ((*Object).joyX != (*Object).cursorX || (*Object).joyY != (*Object).cursorY) {
+        // Both the old and the new position get redrawn
+        markSprite((*Object).cursorX, (*Object).cursorY, (Object == &PacMan) ? pacManShape : ghostShape);
+        markSprite((*Object).joyX, (*Object).joyY, (Object == &PacMan) ? pacManShape : ghostShape);
         if (Object == &PacMan) {
-            updateDrawnPacMan();
+            pacManOpen = (movement > 3); // Opens and closes the mouth every 4 moves
             movement += 1;
             // Loops movement back to 0
             if (movement == 8) {
                 movement = 0;
             }
         }
-        else {
-            updateDrawnGhosts();
-        }
         (*Object).cursorX = (*Object).joyX;
         (*Object).cursorY = (*Object).joyY;
     }
     // Happens when PacMan hits a wall, ensuring his mouth is always open
     else {
         if (Object == &PacMan) {
-            drawPacMan(PacMan.joyX, PacMan.joyY, PacMan.color);
+            pacManOpen = true;
+            markSprite(PacMan.joyX, PacMan.joyY, pacManShape);
         }
     }
 }
@@ -1453,57 +2956,23 @@ void updateCursor(sprite* Object) {
 void updateCustom() {
     // (If joy has been moved in Y direction)
     if (mainJoyY != mainCursorY) {
-
-        // Makes the old text number white text with black background
-        tft.setCursor(60, 64 + (22 * mainCursorY));
-        tft.setTextColor(0xFFFF, 0x0000);
-        tft.print(customMenuArray[mainCursorY]);
-
-        // Makes the new text number black text with white background
-        tft.setCursor(60, 64 + (22 * mainJoyY));
-        tft.setTextColor(0x0000, 0xFFFF);
-        tft.print(customMenuArray[mainJoyY]);
+        // Deselects the old number and selects the new one
+        customWidgets[CUSTOM_FIRST_VALUE + (2 * mainCursorY)].selected = false;
+        customWidgets[CUSTOM_FIRST_VALUE + (2 * mainCursorY)].dirty = true;
+        customWidgets[CUSTOM_FIRST_VALUE + (2 * mainJoyY)].selected = true;
+        customWidgets[CUSTOM_FIRST_VALUE + (2 * mainJoyY)].dirty = true;
 
         mainCursorY = mainJoyY;
         mainCursorX = customMenuArray[mainJoyY]; // syncs xCursor with number
-        delay(150);
     }
     // If joy has been moved in x direciton
     else if (mainJoyX != mainCursorX) {
-
-        // Increases text number on screen
-        tft.setCursor(60, 64 + (22 * mainCursorY));
-        tft.setTextColor(0x0000,0xFFFF);
-        tft.print(mainJoyX);
+        // Changes the selected number
         mainCursorX = mainJoyX;
         customMenuArray[mainCursorY] = mainJoyX;
-        delay(150);
-    }
-}
-
-// Update ghosts on screen depending on joy movement
-void updateDrawnGhosts() {
-    // Lopps for all ghosts
-    for (j = 0; j < menu.numOfGhosts; j++) {
-        // Draws the screen black for previous ghost position
-        drawGhostBlack((*(GhostPointer + j)).cursorX, (*(GhostPointer + j)).cursorY);
-        // Draws the ghost in new position
-        drawGhost((*(GhostPointer + j)).joyX, (*(GhostPointer + j)).joyY, GhostPointer + j);
-      }
-}
-
-// Update PacMan on screen depending on joy movement
-void updateDrawnPacMan() {
-    // Draws black in previous position
-    drawCircle(PacMan.cursorX, PacMan.cursorY, ST7735_BLACK);
-    // If the mouth should be open
-    if (movement > 3) {
-        drawPacMan(PacMan.joyX, PacMan.joyY, PacMan.color);
-    }
-    // If the mouth should be closed
-    else {
-        drawCircle(PacMan.joyX, PacMan.joyY, PacMan.color);
+        customWidgets[CUSTOM_FIRST_VALUE + (2 * mainCursorY)].dirty = true;
     }
+    lcd_widgets_draw(customWidgets, NUM_CUSTOM_WIDGETS, &tft);
 }
 
 // Updates the status of the game (level completion or death)
@@ -1511,26 +2980,19 @@ void updateGame() {
     totalScore = score + ghostScore;
     // If score has reached its max (ie finishing a level)
     if (totalScore == resetScore) {
-        delay(1500);
-        mode = 5; // reset level mode
+        // freeze screen, then reset level mode
+        freezeMode = 5;
+        freezeEnd = millis() + FREEZE_MILLIS;
     }
     // Loops for all ghosts
     for (m = 0; m < menu.numOfGhosts; m++) {
         // If a ghost is 2 away from PacMan in the x and y direction
         if ((abs(PacMan.cursorX - (*(GhostPointer + m)).cursorX) <= 2 && abs(PacMan.cursorY - (*(GhostPointer + m)).cursorY) <= 2)) {
-            delay(1500); // freeze screen
             menu.lives--; // reduce lives
             customMenuArray[3]--; // reduce lives in array
-            drawCircle(PacMan.cursorX, PacMan.cursorY, ST7735_BLACK); // Make PacMan dissapear
-            // Make every ghost dissapear
-            for (n = 0; n < menu.numOfGhosts; n++) {
-                drawGhostBlack((*(GhostPointer + n)).cursorX, (*(GhostPointer + n)).cursorY);
-            }
-            mode = 6; // reset death mode
-            // If game over...
-            if (menu.lives == 0) {
-                mode = 1; // reset game
-            }
+            // freeze screen, then reset death mode (see updateTransition)
+            freezeMode = 6;
+            freezeEnd = millis() + FREEZE_MILLIS;
             break;
         }
     }
@@ -1538,9 +3000,12 @@ void updateGame() {
 
 // Updates PacMan one ups
 void updateLives() {
+    SPI_STATS_SCOPE("updateLives");
     if (score == oneUpScore) {
-        drawCircle(29 + (16 * menu.lives), 309, PacMan.color); // draws circle in lives row
-        tft.fillRect(15 + (8 * menu.lives), 154, 3, 2, ST7735_BLACK); // draws mouth
+        if (!headless) {
+            drawCircle(29 + (16 * menu.lives), 309, PacMan.color); // draws circle in lives row
+            tft.fillRect(15 + (8 * menu.lives), 154, 3, 2, ST7735_BLACK); // draws mouth
+        }
         menu.lives += 1; // increases lives
         customMenuArray[3] += 1; // increases lives in array
         oneUpScore += 5000; // increases one up score
@@ -1551,30 +3016,14 @@ void updateLives() {
 void updateMain() {
     // If request to move in y direction
     if (mainJoyY != mainCursorY) {
-        // If currently on One Player...
-        if (mainJoyY == 0) {
-            // Set One Player on black background, custom on white
-            tft.setTextColor(0x0000, 0xFFFF);
-            tft.setCursor(34, 90);
-            tft.setTextSize(1);
-            tft.print("One Player");
-            tft.setCursor(46, 102);
-            tft.setTextColor(0xFFFF, 0x0000);
-            tft.print("Custom");
-        }
-        // If currently on custom...
-        else {
-            // Set One Player on white background, custom on black
-            tft.setTextColor(0xFFFF, 0x0000);
-            tft.setCursor(34, 90);
-            tft.setTextSize(1);
-            tft.print("One Player");
-            tft.setCursor(46, 102);
-            tft.setTextColor(0x0000, 0xFFFF);
-            tft.print("Custom");
-        }
+        // Deselects the old option (0 One Player, 1 Custom, 2 Resume) and selects the new one
+        mainWidgets[1 + mainCursorY].selected = false;
+        mainWidgets[1 + mainCursorY].dirty = true;
+        mainWidgets[1 + mainJoyY].selected = true;
+        mainWidgets[1 + mainJoyY].dirty = true;
         mainCursorY = mainJoyY;
     }
+    lcd_widgets_draw(mainWidgets, NUM_MAIN_WIDGETS, &tft); // only the options that changed
 }
 
 // Updates the menu struct based on custom array values
@@ -1704,8 +3153,9 @@ void updatePrevNextY(sprite* Object) {
 
 // Updates the score
 void updateScore() {
-  // If score has changed
-  if (prevScore != score) {
+  SPI_STATS_SCOPE("updateScore");
+  // If score has changed (and it is being drawn)
+  if (prevScore != score && !headless) {
       // Reprints the score and updates it
       tft.setTextSize(1);
       tft.setTextColor(0xFFFF, 0x0000);
@@ -1731,3 +3181,73 @@ void updateSprite(sprite* Object) {
         updateOther(Object);
     }
 }
+
+// Runs level loading, the start countdown and freezes a frame at a time, returns true when the game itself should run
+bool updateTransition() {
+    SPI_STATS_SCOPE("updateTransition");
+    TRACE_SCOPE("updateTransition");
+    // Draws the next rows of the map image
+    if (loadRow < viewRows()) {
+        uint16_t rows = min(LOAD_ROWS_PER_FRAME, viewRows() - loadRow);
+        drawMapRows(loadRow, rows);
+        loadRow += rows;
+        // Sprites go on top once the map is done
+        if (loadRow == viewRows()) {
+            loadPacMan();
+            loadGhosts();
+        }
+        return false;
+    }
+    // Counts down whatever is left of LEVEL_START_MILLIS
+    if (startPending) {
+        long remaining = (long) (playTime - millis());
+        uint8_t number = (remaining > 0) ? (remaining / 1000) + 1 : 0;
+        if (number != countdown) {
+            tft.fillRect(116, 152, 6, 8, ST7735_BLACK);
+            if (number != 0) {
+                tft.setCursor(116, 152);
+                tft.setTextSize(1);
+                tft.setTextColor(0xFFFF, 0x0000);
+                tft.print(number);
+            }
+            countdown = number;
+        }
+        startPending = (number != 0);
+        return false;
+    }
+    // Freeze after a death or finished level
+    if (freezeMode != 0) {
+        if ((long) (freezeEnd - millis()) > 0) {
+            return false;
+        }
+        mode = freezeMode;
+        // After a death
+        if (freezeMode == 6) {
+            // Make PacMan dissapear
+            if (inView(PacMan.cursorX, PacMan.cursorY)) {
+                drawCircle(PacMan.cursorX - 2 * cameraX, PacMan.cursorY - 2 * cameraY, ST7735_BLACK);
+            }
+            // Make every ghost dissapear
+            for (n = 0; n < menu.numOfGhosts; n++) {
+                drawGhostBlack((*(GhostPointer + n)).cursorX, (*(GhostPointer + n)).cursorY);
+            }
+            // If game over...
+            if (menu.lives == 0) {
+                mode = 1; // reset game
+            }
+        }
+        freezeMode = 0;
+        return false;
+    }
+    return true;
+}
+
+// Screen columns the map takes up
+uint16_t viewCollums() {
+    return min((*Map.image).ncols, VIEW_WIDTH);
+}
+
+// Screen rows the map takes up
+uint16_t viewRows() {
+    return min((*Map.image).nrows, VIEW_HEIGHT);
+}
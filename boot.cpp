@@ -0,0 +1,49 @@
+/*
+ * Boot timeline. Start-up steps are stamped with micros() and printed
+ * over Serial once start-up is over.
+ */
+
+#include <Arduino.h>
+
+#include "boot.h"
+
+static const char *boot_steps[BOOT_MAX_STEPS];
+static uint32_t boot_ends[BOOT_MAX_STEPS]; // micros() at the end of each step
+static uint8_t boot_count = 0;
+static bool boot_done = false; // the report has been printed
+
+// Prints micros as milliseconds with one decimal
+static void boot_print_ms(uint32_t micros) {
+  Serial.print(micros / 1000);
+  Serial.print('.');
+  Serial.print((micros / 100) % 10);
+}
+
+void boot_mark(const char *step) {
+  if (boot_done || boot_count == BOOT_MAX_STEPS) {
+    return;
+  }
+  boot_ends[boot_count] = micros();
+  boot_steps[boot_count] = step;
+  boot_count++;
+}
+
+void boot_report() {
+  uint32_t start = 0;
+
+  if (boot_done) {
+    return;
+  }
+  boot_done = true;
+  Serial.println("Boot timeline (ms from reset, ms in step):");
+  for (uint8_t i = 0; i < boot_count; i++) {
+    Serial.print("  ");
+    Serial.print(boot_steps[i]);
+    Serial.print(' ');
+    boot_print_ms(boot_ends[i]);
+    Serial.print(' ');
+    boot_print_ms(boot_ends[i] - start);
+    Serial.println();
+    start = boot_ends[i];
+  }
+}
@@ -0,0 +1,34 @@
+/*
+ * Boot timeline. The end of every start-up step is stamped with micros(),
+ * which counts from reset, and the steps are printed over Serial once
+ * start-up is over, so the share of each step in the time to the main
+ * menu can be seen.
+ *
+ * The BOOT_ macros compile to nothing unless BOOT_TIMELINE is defined.
+ */
+
+#ifndef _BOOT_H
+#define _BOOT_H
+
+#define BOOT_MAX_STEPS 10 // steps stamped, later ones are dropped
+
+/* Stamps the end of a start-up step. Does nothing after boot_report.
+ *
+ * step : step name, the string must outlive the report
+ */
+void boot_mark(const char *step);
+
+/* Prints every step with the time from reset to its end and its own
+ * time, in milliseconds. Only the first call prints.
+ */
+void boot_report();
+
+#ifdef BOOT_TIMELINE
+#define BOOT_MARK(step) boot_mark(step)
+#define BOOT_REPORT() boot_report()
+#else
+#define BOOT_MARK(step)
+#define BOOT_REPORT()
+#endif
+
+#endif
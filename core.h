@@ -0,0 +1,89 @@
+/*
+ * Game core API, for driving games from code without the display or the
+ * joystick: agents, analysis tools and the simulator. Games are played
+ * headless, a step runs any number of frames in one call and the state
+ * is observed through a buffer the caller owns, filled in once per call.
+ * The dot grid is not copied, the observation points at the dots the
+ * game plays with.
+ *
+ * Implemented by FinalProject.cpp, which holds the game state. Only one
+ * game runs at a time and it shares that state with the game on the
+ * display, so the core must not be used while a game is on the display.
+ *
+ * Built with CORE_SERIAL the board runs the core for a computer instead
+ * of the game, driven by commands over Serial (9600 baud, values little
+ * endian):
+ *   'C' core_config       : core_create with the config
+ *   'R' seed (4 bytes)    : core_reset
+ *   'S' n (2 bytes) input : core_step with n input bytes
+ *   'A' n (2 bytes)       : core_step with PacMan steering himself
+ *   'O'                   : replies with the observation up to xDots,
+ *                           then the numOfXDots and numOfYDots dots
+ */
+
+#ifndef _CORE_H
+#define _CORE_H
+
+#define CORE_VERSION 1 // version of the observation layout
+#define CORE_MAX_GHOSTS 4
+#define CORE_SERIAL_INPUTS 64 // inputs read from Serial per core_step
+
+// Game settings, kept for every core_reset
+struct core_config {
+  uint8_t numOfGhosts; // 1-4
+  uint8_t difficulty; // 1-4
+  uint8_t lives; // 1-9
+  uint8_t map; // 1 for now
+};
+
+/* Game state after a core_reset or core_step. Positions are in map
+ * coordinates (2 per pixel), as the game keeps them.
+ */
+struct core_observation {
+  uint8_t version; // CORE_VERSION
+  uint8_t numOfGhosts;
+  uint8_t lives; // lives left, 0 once the game is over
+  uint32_t ticks; // frames played since core_reset
+  uint16_t levels; // levels finished
+  uint16_t deaths; // lives lost
+  int32_t score; // PacMan score
+  int32_t ghostScore; // ghosts score
+  int16_t pacManX, pacManY;
+  int16_t ghostX[CORE_MAX_GHOSTS], ghostY[CORE_MAX_GHOSTS];
+  uint16_t numOfXDots; // dot spaces in the rows of the maze
+  uint16_t numOfYDots; // dot spaces in the collums of the maze
+  const uint8_t *xDots; // the game's row dots, 0 for an empty space
+  const uint8_t *yDots; // the game's collum dots, 0 for an empty space
+};
+
+/* Sets up games with config. The observation is filled in by every
+ * core_reset and core_step from now on.
+ *
+ * config      : game settings
+ * observation : caller owned, must outlive the calls that fill it
+ */
+void core_create(struct core_config *config, struct core_observation *observation);
+
+/* Starts a new game on the first level.
+ *
+ * seed : seed of the game's random numbers, a seed always plays the
+ *        same game for the same inputs
+ */
+void core_reset(uint32_t seed);
+
+/* Plays frames of the game until ticks frames are played or the game is
+ * over.
+ *
+ * inputs  : PacMan's input for each frame, as recorded by replays
+ *           (horizontal in bits 0-1, vertical in bits 2-3, each 0 for
+ *           none, 1 for left/up and 2 for right/down), or NULL for
+ *           PacMan to steer himself like in the simulator
+ * ticks   : frames to play
+ * returns : frames played
+ */
+uint32_t core_step(const uint8_t *inputs, uint32_t ticks);
+
+/* Returns the observation buffer given to core_create. */
+struct core_observation *core_observe();
+
+#endif
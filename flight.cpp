@@ -0,0 +1,139 @@
+/*
+ * Flight recorder. Frames are recorded into a ring in RAM and the ring
+ * is appended to the SD card from flight_idle, after the frame that
+ * asked for it.
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <SD.h>
+
+#include "flight.h"
+
+static flight_frame_t flight_frames[FLIGHT_FRAMES];
+static uint8_t flight_next = 0; // slot of the next frame
+static uint8_t flight_count = 0; // frames in the ring
+
+static const char *flight_file_name = NULL;
+static int *flight_settings;
+static uint8_t flight_num_settings = 0;
+static uint16_t flight_period = 0;
+
+static uint32_t flight_level_seed = 0;
+static uint16_t flight_frame = 0; // frames played since the seed
+static uint32_t flight_frame_start; // micros() at the start of the frame
+static unsigned long flight_frame_millis; // millis() at the start of the frame
+static uint32_t flight_phase_start; // micros() at the end of the last phase
+static unsigned long flight_last_start = 0; // millis() at the start of the last played frame, 0 to skip the overrun check
+static bool flight_playing = false; // the frame is played
+static uint8_t flight_reason = 0; // reason of the dump asked for, 0 for none
+
+// Microseconds since start, at most 65535
+static uint16_t flight_micros(uint32_t start) {
+  return min(micros() - start, 65535UL);
+}
+
+void flight_start(const char *file_name, int *settings, uint8_t count, uint16_t period) {
+  flight_file_name = file_name;
+  flight_settings = settings;
+  flight_num_settings = min(count, FLIGHT_MAX_SETTINGS);
+  flight_period = period;
+}
+
+uint32_t flight_seed(uint32_t seed) {
+  flight_level_seed = seed;
+  flight_frame = 0;
+  flight_last_start = 0; // loading the level took its time
+  return seed;
+}
+
+void flight_frame_begin() {
+  // Loading, countdowns and freezes take their own time, only a played frame after a played frame is checked
+  if (!flight_playing) {
+    flight_last_start = 0;
+  }
+  flight_playing = false;
+  flight_frame_millis = millis();
+  flight_frame_start = micros();
+}
+
+void flight_frame_played() {
+  flight_frame_t *frame = &flight_frames[flight_next];
+
+  memset(frame, 0, sizeof(flight_frame_t));
+  frame->frame = flight_frame++;
+  if (flight_last_start != 0) {
+    frame->interval = min(flight_frame_millis - flight_last_start, 65535UL);
+    if (flight_period != 0 && frame->interval > FLIGHT_OVERRUN * flight_period) {
+      flight_dump(FLIGHT_REASON_OVERRUN);
+    }
+  }
+  flight_last_start = flight_frame_millis;
+  flight_playing = true;
+  flight_phase_start = micros();
+}
+
+void flight_phase(uint8_t phase) {
+  flight_frames[flight_next].phases[phase] = flight_micros(flight_phase_start);
+  flight_phase_start = micros();
+}
+
+void flight_input(uint8_t input) {
+  flight_frames[flight_next].input = input;
+}
+
+void flight_frame_end(uint16_t (*hash)(), int16_t *sprites, uint8_t count) {
+  flight_frame_t *frame = &flight_frames[flight_next];
+
+  frame->hash = hash();
+  for (uint8_t i = 0; i < count && i < FLIGHT_SPRITES; i++) {
+    frame->x[i] = sprites[2 * i];
+    frame->y[i] = sprites[2 * i + 1];
+  }
+  frame->time = flight_micros(flight_frame_start);
+  flight_next = (flight_next + 1) % FLIGHT_FRAMES;
+  if (flight_count < FLIGHT_FRAMES) {
+    flight_count++;
+  }
+}
+
+void flight_dump(uint8_t reason) {
+  // A death explains the frames around it better than a slow frame
+  if (flight_reason != FLIGHT_REASON_DEATH) {
+    flight_reason = reason;
+  }
+}
+
+void flight_idle() {
+  File file;
+
+  if (flight_reason == 0) {
+    return;
+  }
+  if (flight_file_name != NULL && (file = SD.open(flight_file_name, FILE_WRITE))) {
+    uint8_t slot = (flight_next + FLIGHT_FRAMES - flight_count) % FLIGHT_FRAMES;
+
+    file.write('F');
+    file.write('L');
+    file.write((uint8_t) FLIGHT_VERSION);
+    file.write(flight_reason);
+    file.write((uint8_t*) &flight_level_seed, sizeof(flight_level_seed));
+    file.write(flight_num_settings);
+    for (uint8_t i = 0; i < flight_num_settings; i++) {
+      file.write((uint8_t) flight_settings[i]);
+    }
+    file.write(flight_count);
+    // Oldest first, the ring may wrap around
+    for (uint8_t i = 0; i < flight_count; i++) {
+      file.write((uint8_t*) &flight_frames[slot], sizeof(flight_frame_t));
+      slot = (slot + 1) % FLIGHT_FRAMES;
+    }
+    file.close();
+    Serial.print("Flight recorder: ");
+    Serial.print(flight_count);
+    Serial.println(flight_reason == FLIGHT_REASON_DEATH ? " frames before a death saved" : " frames before an overrun saved");
+  }
+  flight_reason = 0;
+  flight_count = 0; // a frame is dumped once
+  flight_last_start = 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Flight recorder. The last FLIGHT_FRAMES game frames are kept in a RAM
+ * ring: when each frame started, how long it and its phases took, the
+ * joystick input, a hash of the game state and the sprite positions. The
+ * ring is appended to a file on the SD card when a frame starts more
+ * than FLIGHT_OVERRUN frame periods after the one before it, or when
+ * PacMan dies, so a rare frame drop arrives with the frames that led up
+ * to it. Only frames the game is played in are recorded, not the ones
+ * spent loading a level, counting down, frozen or waiting for the other
+ * board, the same frames a replay records input for.
+ *
+ * The random number generator's state can't be read back, so a dump
+ * holds the seed of the level and the number of every frame since it
+ * instead. With a recording of the same game (REPLAY_RECORD) the frames
+ * can be found in the replay and checked against its state hashes.
+ *
+ * File layout (little endian), one dump after the other:
+ *   'F' 'L' version reason seed (4 bytes) count settings[count]
+ *   frames (1 byte) flight_frame_t[frames], oldest first
+ *
+ * The FLIGHT_ macros compile to nothing unless FLIGHT_RECORDER is defined.
+ */
+
+#ifndef _FLIGHT_H
+#define _FLIGHT_H
+
+#define FLIGHT_VERSION 1
+#ifndef FLIGHT_FRAMES
+#define FLIGHT_FRAMES 32 // frames kept, 33 bytes of SRAM each
+#endif
+#ifndef FLIGHT_OVERRUN
+#define FLIGHT_OVERRUN 2 // frame periods between frame starts that count as an overrun
+#endif
+#define FLIGHT_SPRITES 5 // PacMan and 4 ghosts
+#define FLIGHT_MAX_SETTINGS 8
+
+// Phases timed within a frame
+#define FLIGHT_SCAN 0
+#define FLIGHT_UPDATE 1
+#define FLIGHT_PHASES 2
+
+// Reasons for a dump
+#define FLIGHT_REASON_OVERRUN 'O'
+#define FLIGHT_REASON_DEATH 'D'
+
+struct flight_frame_t {
+  uint16_t frame; // frames played since the level's seed
+  uint16_t interval; // milliseconds since the frame before started, 0 if it was not played
+  uint16_t time; // microseconds the frame took, at most 65535
+  uint16_t phases[FLIGHT_PHASES]; // microseconds each phase took, the rest went to transitions
+  uint8_t input; // joystick input, as replays record it
+  uint16_t hash; // hash of the game state at the end of the frame
+  int16_t x[FLIGHT_SPRITES]; // sprite positions, PacMan first (0 for missing ghosts)
+  int16_t y[FLIGHT_SPRITES];
+};
+
+/* Starts writing dumps to a file on the SD card, appended after the
+ * dumps already in it. Frames are recorded whether or not it is called.
+ *
+ * file_name : name of the file to write to, the string must outlive the
+ *             recorder
+ * settings  : game settings written with every dump, read at the time of
+ *             the dump
+ * count     : number of settings, at most FLIGHT_MAX_SETTINGS
+ * period    : milliseconds a frame is meant to take
+ */
+void flight_start(const char *file_name, int *settings, uint8_t count, uint16_t period);
+
+/* Notes the random seed of a new level and restarts the frame numbers.
+ *
+ * returns : seed
+ */
+uint32_t flight_seed(uint32_t seed);
+
+/* Starts a frame, call it at the start of every frame whether or not it
+ * is played.
+ */
+void flight_frame_begin();
+
+/* Records the frame started by flight_frame_begin, the game is played in
+ * it. Asks for a dump if it started too late after a played frame.
+ */
+void flight_frame_played();
+
+/* Ends a phase of the frame, which started when the last phase ended or
+ * flight_frame_played was called.
+ *
+ * phase : FLIGHT_SCAN or FLIGHT_UPDATE
+ */
+void flight_phase(uint8_t phase);
+
+/* Notes the joystick input of the frame. */
+void flight_input(uint8_t input);
+
+/* Ends a played frame.
+ *
+ * hash    : computes a hash of the game state
+ * sprites : x and y of each sprite, in pairs
+ * count   : number of sprites, at most FLIGHT_SPRITES
+ */
+void flight_frame_end(uint16_t (*hash)(), int16_t *sprites, uint8_t count);
+
+/* Asks for a dump once the frame ends.
+ *
+ * reason : FLIGHT_REASON_DEATH or FLIGHT_REASON_OVERRUN
+ */
+void flight_dump(uint8_t reason);
+
+/* Writes an asked for dump to the card, call it when there is time to
+ * spare. The frame after a dump is not checked for an overrun, since
+ * writing the dump delays it.
+ */
+void flight_idle();
+
+#ifdef FLIGHT_RECORDER
+#define FLIGHT_START(file_name, settings, count, period) flight_start(file_name, settings, count, period)
+#define FLIGHT_SEED(seed) flight_seed(seed)
+#define FLIGHT_FRAME_BEGIN() flight_frame_begin()
+#define FLIGHT_FRAME_PLAYED() flight_frame_played()
+#define FLIGHT_PHASE(phase) flight_phase(phase)
+#define FLIGHT_INPUT(input) flight_input(input)
+#define FLIGHT_DUMP(reason) flight_dump(reason)
+#define FLIGHT_IDLE() flight_idle()
+#else
+#define FLIGHT_START(file_name, settings, count, period)
+#define FLIGHT_SEED(seed) (seed)
+#define FLIGHT_FRAME_BEGIN()
+#define FLIGHT_FRAME_PLAYED()
+#define FLIGHT_PHASE(phase)
+#define FLIGHT_INPUT(input)
+#define FLIGHT_DUMP(reason)
+#define FLIGHT_IDLE()
+#endif
+
+#endif
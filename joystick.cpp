@@ -0,0 +1,175 @@
+/*
+ * Interrupt driven joystick sampling. The ADC converts the joystick axes
+ * and the potentiometer on A2 in a repeating sequence, and every change of
+ * joystick zone or select button is queued as an event for the game to
+ * consume. The potentiometer reading seeds the random numbers.
+ */
+
+#include <Arduino.h>
+
+#include "joystick.h"
+
+#define JOY_VERT_CHANNEL 0
+#define JOY_HORIZ_CHANNEL 1
+#define JOY_NOISE_CHANNEL 2 // A2, the potentiometer, whose reading seeds the random numbers
+
+// Compiler barrier: memory accesses are not moved across it, so an event
+// is written before the index that hands it over and read after it
+#define JOY_BARRIER() asm volatile ("" ::: "memory")
+
+// Event queue, written only by the ADC interrupt and read only by
+// joy_poll, so single byte indices are enough to keep it consistent
+static joy_event_t joy_queue[JOY_QUEUE_SIZE];
+static volatile uint8_t joy_head = 0; // next slot the interrupt writes
+static volatile uint8_t joy_tail = 0; // next slot joy_poll reads
+static volatile uint16_t joy_dropped = 0;
+
+// Sampling state, only touched by the interrupt after joy_begin
+static uint8_t joy_channel = JOY_VERT_CHANNEL;
+static int16_t joy_filtered[2]; // axis readings times 4 (moving average)
+static int8_t joy_zones[2]; // zones of the last queued event
+static uint8_t joy_select = HIGH; // select of the last queued event
+static volatile uint16_t joy_noise_reading = 0;
+static volatile uint8_t *joy_sel_port;
+static uint8_t joy_sel_mask;
+
+// Last state handed out by joy_read
+static joy_event_t joy_last = {JOY_EVENT_CENTRE, JOY_EVENT_CENTRE, HIGH};
+
+// Selects the ADC channel and starts a single conversion
+static void joy_convert(uint8_t channel) {
+  ADMUX = (1 << REFS0) | channel; // AVcc reference
+  ADCSRA |= (1 << ADSC);
+}
+
+// Returns -2..2 depending on which side of centre the reading is and
+// which dead zones it is past
+static int8_t joy_zone(int16_t reading) {
+  int16_t offset = reading - JOY_EVENT_CENTRE;
+  int8_t zone = 0;
+
+  if (abs(offset) > JOY_EVENT_FAR) {
+    zone = 2;
+  }
+  else if (abs(offset) > JOY_EVENT_NEAR) {
+    zone = 1;
+  }
+  return (offset < 0) ? -zone : zone;
+}
+
+void joy_begin(uint8_t sel_pin) {
+  pinMode(sel_pin, INPUT);
+  digitalWrite(sel_pin, HIGH); // enables pull-up resistor
+  joy_sel_port = portInputRegister(digitalPinToPort(sel_pin));
+  joy_sel_mask = digitalPinToBitMask(sel_pin);
+
+  joy_filtered[0] = 4 * JOY_EVENT_CENTRE;
+  joy_filtered[1] = 4 * JOY_EVENT_CENTRE;
+
+  // Enable the ADC with its interrupt, 16MHz / 128 = 125kHz ADC clock
+  ADCSRB = 0;
+  ADCSRA = (1 << ADEN) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  joy_channel = JOY_VERT_CHANNEL;
+  joy_convert(joy_channel);
+}
+
+// Conversion complete: store the reading, queue an event if the
+// joystick changed zone, and start converting the next channel
+ISR(ADC_vect) {
+  int16_t reading = ADC;
+
+  if (joy_channel == JOY_NOISE_CHANNEL) {
+    joy_noise_reading = reading;
+  }
+  else {
+    joy_filtered[joy_channel] += reading - joy_filtered[joy_channel] / 4;
+  }
+
+  if (joy_channel == JOY_HORIZ_CHANNEL) {
+    joy_event_t event;
+    event.vert = joy_filtered[0] / 4;
+    event.horiz = joy_filtered[1] / 4;
+    event.select = (*joy_sel_port & joy_sel_mask) ? HIGH : LOW;
+
+    int8_t vert_zone = joy_zone(event.vert);
+    int8_t horiz_zone = joy_zone(event.horiz);
+
+    if (vert_zone != joy_zones[0] || horiz_zone != joy_zones[1] ||
+	event.select != joy_select) {
+      uint8_t next = (joy_head + 1) & (JOY_QUEUE_SIZE - 1);
+
+      // When full the change is not recorded, so it is queued again
+      // once joy_poll has made room
+      if (next == joy_tail) {
+	joy_dropped++;
+      }
+      else {
+	joy_queue[joy_head] = event;
+	JOY_BARRIER();
+	joy_head = next;
+	joy_zones[0] = vert_zone;
+	joy_zones[1] = horiz_zone;
+	joy_select = event.select;
+      }
+    }
+  }
+
+  joy_channel = (joy_channel == JOY_NOISE_CHANNEL) ? JOY_VERT_CHANNEL : joy_channel + 1;
+  joy_convert(joy_channel);
+}
+
+bool joy_poll(joy_event_t *event) {
+  uint8_t tail = joy_tail;
+
+  if (tail == joy_head) {
+    return false;
+  }
+  JOY_BARRIER();
+  *event = joy_queue[tail];
+  JOY_BARRIER();
+  joy_tail = (tail + 1) & (JOY_QUEUE_SIZE - 1);
+  return true;
+}
+
+void joy_read(joy_event_t *event, int16_t dead_zone) {
+  joy_event_t next;
+  bool deflected = false;
+  bool pressed = false;
+
+  *event = joy_last;
+  while (joy_poll(&next)) {
+    bool next_deflected = abs(next.vert - JOY_EVENT_CENTRE) > dead_zone ||
+      abs(next.horiz - JOY_EVENT_CENTRE) > dead_zone;
+
+    // keep the latest push, later centre events don't undo it
+    if (next_deflected || !deflected) {
+      *event = next;
+      deflected = next_deflected;
+    }
+    if (next.select == LOW) {
+      pressed = true;
+    }
+    joy_last = next;
+  }
+  if (pressed) {
+    event->select = LOW;
+  }
+}
+
+uint16_t joy_noise() {
+  uint16_t reading;
+
+  noInterrupts();
+  reading = joy_noise_reading;
+  interrupts();
+  return reading;
+}
+
+uint16_t joy_overflows() {
+  uint16_t dropped;
+
+  noInterrupts();
+  dropped = joy_dropped;
+  interrupts();
+  return dropped;
+}
@@ -0,0 +1,53 @@
+/*
+ * Interrupt driven joystick sampling. The ADC converts the joystick axes
+ * and the potentiometer on A2 in a repeating sequence, and every change of
+ * joystick zone or select button is queued as an event for the game to
+ * consume. The potentiometer reading seeds the random numbers.
+ */
+
+#ifndef _JOYSTICK_H
+#define _JOYSTICK_H
+
+#define JOY_EVENT_CENTRE 512
+#define JOY_EVENT_NEAR 300 // dead zone used by the main menu
+#define JOY_EVENT_FAR 500  // dead zone used by the custom menu and the game
+
+#define JOY_QUEUE_SIZE 16 // must be a power of 2
+
+typedef struct {
+  int16_t vert;   // filtered vertical reading (0-1023)
+  int16_t horiz;  // filtered horizontal reading (0-1023)
+  uint8_t select; // select button, 0 when pushed down
+} joy_event_t;
+
+/* Starts the ADC conversion sequence. analogRead must not be used
+ * once this has been called.
+ *
+ * sel_pin : digital pin of the joystick select button
+ */
+void joy_begin(uint8_t sel_pin);
+
+/* Removes the oldest event from the queue.
+ *
+ * event   : filled with the event
+ * returns : false if there were no events queued
+ */
+bool joy_poll(joy_event_t *event);
+
+/* Consumes every queued event and reports the joystick for this frame.
+ * A push past dead_zone that happened since the last call is reported
+ * even if the joystick is back in the centre, and so is a press of
+ * select. Without new events the last reported state is repeated.
+ *
+ * event     : filled with the joystick state
+ * dead_zone : distance from centre that counts as a push
+ */
+void joy_read(joy_event_t *event, int16_t dead_zone);
+
+/* Latest reading of the potentiometer on A2, used for random seeds. */
+uint16_t joy_noise();
+
+/* Number of events dropped because the queue was full. */
+uint16_t joy_overflows();
+
+#endif
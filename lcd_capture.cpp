@@ -0,0 +1,191 @@
+/*
+ * Frame capture for checking that rendering changes draw the same pixels.
+ * Every pass of a replayed game mirrors one band of LCD_CAPTURE_ROWS
+ * screen rows and writes or compares that band of every captured frame.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+#include <SPI.h>
+#include <SD.h>
+
+#include "lcd_capture.h"
+
+#define LCD_CAPTURE_HEADER "P6\n128 160\n255\n"
+#define LCD_CAPTURE_HEADER_SIZE 15
+
+static uint16_t lcd_shadow[LCD_CAPTURE_ROWS][LCD_CAPTURE_WIDTH];
+static int16_t lcd_band = 0; // first screen row of the band
+static uint32_t lcd_frame = 0; // game frames since the start of the pass
+static bool lcd_capturing = false; // a pass has started and not ended
+
+static int16_t lcd_window_x0, lcd_window_x1, lcd_window_y1;
+static int16_t lcd_cursor_x, lcd_cursor_y; // next pixel of the window
+
+static uint16_t lcd_bad_bands = 0; // FRAME_CHECK: frame bands that differed over all passes
+
+void lcd_capture_start() {
+  memset(lcd_shadow, 0, sizeof(lcd_shadow));
+  lcd_frame = 0;
+  lcd_capturing = true;
+}
+
+bool lcd_capture_next_pass() {
+  if (!lcd_capturing) {
+    return false;
+  }
+  lcd_capturing = false;
+  lcd_band += LCD_CAPTURE_ROWS;
+  if (lcd_band < LCD_CAPTURE_HEIGHT) {
+    Serial.print("Capturing rows from ");
+    Serial.println(lcd_band);
+    return true;
+  }
+  lcd_band = 0;
+#ifdef FRAME_CHECK
+  Serial.print("Frame check ");
+  Serial.print(lcd_bad_bands == 0 ? "passed" : "FAILED, bands differing: ");
+  if (lcd_bad_bands != 0) {
+    Serial.print(lcd_bad_bands);
+  }
+  Serial.println();
+  lcd_bad_bands = 0;
+#endif
+  return false;
+}
+
+// Expands a RGB565 colour to the 3 bytes of a PPM pixel
+static void lcd_capture_rgb(uint16_t color, uint8_t *rgb) {
+  uint8_t r = color >> 11;
+  uint8_t g = (color >> 5) & 0x3F;
+  uint8_t b = color & 0x1F;
+
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+void lcd_capture_frame_end() {
+  char name[13];
+  uint8_t rgb[3 * LCD_CAPTURE_WIDTH];
+  uint8_t rows = min(LCD_CAPTURE_ROWS, LCD_CAPTURE_HEIGHT - lcd_band);
+  File file;
+
+  if (!lcd_capturing || lcd_frame++ % LCD_CAPTURE_EVERY != 0) {
+    return;
+  }
+  sprintf(name, "F%07lu.PPM", (unsigned long) (lcd_frame - 1));
+
+#ifdef FRAME_DUMP
+  // Bands are appended in order, the first pass starts the file
+  if (lcd_band == 0) {
+    SD.remove(name);
+  }
+  if (!(file = SD.open(name, FILE_WRITE))) {
+    return;
+  }
+  if (lcd_band == 0) {
+    file.print(LCD_CAPTURE_HEADER);
+  }
+  for (uint8_t row = 0; row < rows; row++) {
+    for (uint8_t col = 0; col < LCD_CAPTURE_WIDTH; col++) {
+      lcd_capture_rgb(lcd_shadow[row][col], rgb + 3 * col);
+    }
+    file.write(rgb, sizeof(rgb));
+  }
+#else
+  int16_t x0 = LCD_CAPTURE_WIDTH, y0 = LCD_CAPTURE_HEIGHT, x1 = -1, y1 = -1;
+
+  if (!(file = SD.open(name))) {
+    Serial.print("Missing ");
+    Serial.println(name);
+    lcd_bad_bands++;
+    return;
+  }
+  file.seek(LCD_CAPTURE_HEADER_SIZE + (uint32_t) lcd_band * sizeof(rgb));
+  for (uint8_t row = 0; row < rows; row++) {
+    file.read(rgb, sizeof(rgb));
+    for (uint8_t col = 0; col < LCD_CAPTURE_WIDTH; col++) {
+      uint8_t pixel[3];
+
+      lcd_capture_rgb(lcd_shadow[row][col], pixel);
+      if (memcmp(pixel, rgb + 3 * col, 3) != 0) {
+	x0 = min(x0, col);
+	x1 = max(x1, col);
+	y0 = min(y0, lcd_band + row);
+	y1 = max(y1, lcd_band + row);
+      }
+    }
+  }
+  // Reports the bounding box of the pixels that differ
+  if (x1 >= 0) {
+    Serial.print(name);
+    Serial.print(" differs in columns ");
+    Serial.print(x0);
+    Serial.print("-");
+    Serial.print(x1);
+    Serial.print(", rows ");
+    Serial.print(y0);
+    Serial.print("-");
+    Serial.println(y1);
+    lcd_bad_bands++;
+  }
+#endif
+  file.close();
+}
+
+void lcd_capture_window(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+  lcd_window_x0 = x0;
+  lcd_window_x1 = x1;
+  lcd_window_y1 = y1;
+  lcd_cursor_x = x0;
+  lcd_cursor_y = y0;
+}
+
+void lcd_capture_pixel(uint16_t color) {
+  int16_t row = lcd_cursor_y - lcd_band;
+
+  if (row >= 0 && row < LCD_CAPTURE_ROWS && lcd_cursor_y <= lcd_window_y1
+      && lcd_cursor_x >= 0 && lcd_cursor_x < LCD_CAPTURE_WIDTH) {
+    lcd_shadow[row][lcd_cursor_x] = color;
+  }
+  // The display wraps to the next row of the window
+  if (++lcd_cursor_x > lcd_window_x1) {
+    lcd_cursor_x = lcd_window_x0;
+    lcd_cursor_y++;
+  }
+}
+
+void lcd_capture_rect(int16_t x, int16_t y, int16_t w, int16_t h,
+		      uint16_t color) {
+#ifdef LCD_CAPTURE
+  int16_t x1 = min(x + w, LCD_CAPTURE_WIDTH);
+  int16_t y1 = min(y + h, min(lcd_band + LCD_CAPTURE_ROWS, LCD_CAPTURE_HEIGHT));
+
+  for (int16_t row = max(y, lcd_band); row < y1; row++) {
+    for (int16_t col = max(x, 0); col < x1; col++) {
+      lcd_shadow[row - lcd_band][col] = color;
+    }
+  }
+#endif
+}
+
+void lcd_capture_tft::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  lcd_capture_rect(x, y, 1, 1, color);
+  spi_stats_tft::drawPixel(x, y, color);
+}
+
+void lcd_capture_tft::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  lcd_capture_rect(x, y, 1, h, color);
+  spi_stats_tft::drawFastVLine(x, y, h, color);
+}
+
+void lcd_capture_tft::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  lcd_capture_rect(x, y, w, 1, color);
+  spi_stats_tft::drawFastHLine(x, y, w, color);
+}
+
+void lcd_capture_tft::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  lcd_capture_rect(x, y, w, h, color);
+  spi_stats_tft::fillRect(x, y, w, h, color);
+}
@@ -0,0 +1,81 @@
+/*
+ * Frame capture for checking that rendering changes draw the same pixels.
+ * Everything drawn to the LCD display is mirrored into a shadow copy of
+ * LCD_CAPTURE_ROWS screen rows. A whole screen does not fit in SRAM, so
+ * a replayed game is played once per band of rows, each pass filling in
+ * its band of every captured frame.
+ *
+ * Built with FRAME_DUMP every LCD_CAPTURE_EVERY game frames is written
+ * as a PPM image, F<frame>.PPM, on the SD card. Built with FRAME_CHECK
+ * the frames are compared with those images instead, and every band
+ * that differs is printed with the region that differs.
+ *
+ * The LCD_CAPTURE_ macros compile to nothing unless FRAME_DUMP or
+ * FRAME_CHECK is defined.
+ */
+
+#ifndef _LCD_CAPTURE_H
+#define _LCD_CAPTURE_H
+
+#include "spi_stats.h"
+
+#ifndef LCD_CAPTURE_ROWS
+#define LCD_CAPTURE_ROWS 4 // rows per pass, 256 bytes of SRAM each
+#endif
+#ifndef LCD_CAPTURE_EVERY
+#define LCD_CAPTURE_EVERY 32 // game frames between captured frames, 1 for the whole run
+#endif
+#define LCD_CAPTURE_WIDTH 128
+#define LCD_CAPTURE_HEIGHT 160
+
+/* Starts capturing a pass of a replayed game from its first frame. */
+void lcd_capture_start();
+
+/* Ends the pass started by lcd_capture_start, if any, and moves on to
+ * the next band of rows.
+ *
+ * returns : true if the game has to be replayed for another band
+ */
+bool lcd_capture_next_pass();
+
+/* Ends a game frame, captured frames are written or compared. */
+void lcd_capture_frame_end();
+
+/* Follows a setAddrWindow, lcd_capture_pixel then fills the window. */
+void lcd_capture_window(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+/* Follows a pushColor. */
+void lcd_capture_pixel(uint16_t color);
+
+/* Records a filled rectangle. */
+void lcd_capture_rect(int16_t x, int16_t y, int16_t w, int16_t h,
+		      uint16_t color);
+
+// Display that mirrors what the Adafruit_GFX drawing primitives draw
+class lcd_capture_tft : public spi_stats_tft {
+ public:
+  lcd_capture_tft(int8_t cs, int8_t dc, int8_t rst)
+    : spi_stats_tft(cs, dc, rst) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+};
+
+#if defined(FRAME_DUMP) || defined(FRAME_CHECK)
+#define LCD_CAPTURE
+#define LCD_CAPTURE_START() lcd_capture_start()
+#define LCD_CAPTURE_NEXT_PASS() lcd_capture_next_pass()
+#define LCD_CAPTURE_FRAME_END() lcd_capture_frame_end()
+#define LCD_CAPTURE_WINDOW(x0, y0, x1, y1) lcd_capture_window(x0, y0, x1, y1)
+#define LCD_CAPTURE_PIXEL(color) lcd_capture_pixel(color)
+#else
+#define LCD_CAPTURE_START()
+#define LCD_CAPTURE_NEXT_PASS() false
+#define LCD_CAPTURE_FRAME_END()
+#define LCD_CAPTURE_WINDOW(x0, y0, x1, y1)
+#define LCD_CAPTURE_PIXEL(color)
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Line buffer compositor. Dirty spans of the screen are collected during
+ * a frame, then every dirty pixel is built in RAM by a callback and sent
+ * to the LCD display exactly once.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+
+#include "lcd_compose.h"
+#include "spi_stats.h"
+#include "lcd_capture.h"
+
+typedef struct {
+  uint8_t y;
+  uint8_t x0; // first pixel
+  uint8_t x1; // last pixel
+} lcd_span_t;
+
+static lcd_span_t lcd_spans[LCD_COMPOSE_MAX_SPANS];
+static uint8_t lcd_num_spans = 0;
+
+static lcd_compose_fn lcd_pending_compose = NULL; // callback of the last draw, used when the list fills up
+static Adafruit_ST7735 *lcd_pending_tft = NULL;
+
+// Composes pixels x0 to x1 of row y in passes of LCD_COMPOSE_MAX_WIDTH
+static void lcd_compose_span(Adafruit_ST7735 *tft, lcd_compose_fn compose,
+			     uint8_t y, uint8_t x0, uint8_t x1) {
+  uint16_t line[LCD_COMPOSE_MAX_WIDTH];
+
+  tft->setAddrWindow(x0, y, x1, y);
+  SPI_STATS_WINDOW(x1 - x0 + 1);
+  LCD_CAPTURE_WINDOW(x0, y, x1, y);
+  for (uint16_t x = x0; x <= x1; x += LCD_COMPOSE_MAX_WIDTH) {
+    uint8_t width = min(LCD_COMPOSE_MAX_WIDTH, x1 - x + 1);
+
+    compose(line, x, y, width);
+    for (uint8_t i = 0; i < width; i++) {
+      tft->pushColor(line[i]);
+      LCD_CAPTURE_PIXEL(line[i]);
+    }
+  }
+}
+
+void lcd_compose_add(int16_t x, int16_t y, uint8_t width) {
+  int16_t x1 = x + width - 1;
+
+  if (y < 0 || y >= LCD_COMPOSE_HEIGHT || x1 < 0 || x >= LCD_COMPOSE_WIDTH) {
+    return;
+  }
+  // A full list is drawn straight away rather than losing a span
+  if (lcd_num_spans == LCD_COMPOSE_MAX_SPANS && lcd_pending_tft != NULL) {
+    lcd_compose_draw(lcd_pending_tft, lcd_pending_compose);
+  }
+  if (lcd_num_spans == LCD_COMPOSE_MAX_SPANS) {
+    return;
+  }
+  lcd_spans[lcd_num_spans].y = y;
+  lcd_spans[lcd_num_spans].x0 = max(x, 0);
+  lcd_spans[lcd_num_spans].x1 = min(x1, LCD_COMPOSE_WIDTH - 1);
+  lcd_num_spans++;
+}
+
+void lcd_compose_draw(Adafruit_ST7735 *tft, lcd_compose_fn compose) {
+  SPI_STATS_SCOPE("lcd_compose_draw");
+  lcd_pending_tft = tft;
+  lcd_pending_compose = compose;
+
+  // Insertion sort by row then first pixel, the list is short
+  for (uint8_t i = 1; i < lcd_num_spans; i++) {
+    lcd_span_t span = lcd_spans[i];
+    uint8_t j = i;
+
+    while (j > 0 && (lcd_spans[j - 1].y > span.y ||
+		     (lcd_spans[j - 1].y == span.y && lcd_spans[j - 1].x0 > span.x0))) {
+      lcd_spans[j] = lcd_spans[j - 1];
+      j--;
+    }
+    lcd_spans[j] = span;
+  }
+
+  // Merges overlapping or touching spans in a row, then draws each merged span
+  uint8_t i = 0;
+  while (i < lcd_num_spans) {
+    uint8_t y = lcd_spans[i].y;
+    uint8_t x0 = lcd_spans[i].x0;
+    uint8_t x1 = lcd_spans[i].x1;
+
+    for (i++; i < lcd_num_spans && lcd_spans[i].y == y && lcd_spans[i].x0 <= x1 + 1; i++) {
+      x1 = max(x1, lcd_spans[i].x1);
+    }
+    lcd_compose_span(tft, compose, y, x0, x1);
+  }
+
+  lcd_num_spans = 0;
+}
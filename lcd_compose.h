@@ -0,0 +1,38 @@
+/*
+ * Line buffer compositor. Dirty spans of the screen are collected during
+ * a frame, then every dirty pixel is built in RAM by a callback and sent
+ * to the LCD display exactly once.
+ */
+
+#ifndef _LCD_COMPOSE_H
+#define _LCD_COMPOSE_H
+
+#define LCD_COMPOSE_MAX_SPANS 64 // dirty spans per frame, extra spans are drawn at once
+#define LCD_COMPOSE_MAX_WIDTH 32 // pixels composed per pass, longer spans are split
+
+#define LCD_COMPOSE_WIDTH 128
+#define LCD_COMPOSE_HEIGHT 160
+
+/* Fills line with the final colours of width pixels starting at x, y.
+ * It is called with width <= LCD_COMPOSE_MAX_WIDTH.
+ */
+typedef void (*lcd_compose_fn)(uint16_t *line, int16_t x, int16_t y,
+			       uint8_t width);
+
+/* Marks a horizontal span of the screen as dirty. Parts of the span
+ * off the screen are ignored.
+ *
+ * x, y  : the leftmost pixel of the span
+ * width : the length of the span
+ */
+void lcd_compose_add(int16_t x, int16_t y, uint8_t width);
+
+/* Composes and draws every dirty pixel once, overlapping spans are
+ * merged first, then forgets the spans.
+ *
+ * tft     : the initialized tft struct
+ * compose : builds the pixels of a span
+ */
+void lcd_compose_draw(Adafruit_ST7735 *tft, lcd_compose_fn compose);
+
+#endif
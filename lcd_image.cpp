@@ -1,5 +1,7 @@
 /*
  * Routine for drawing an image patch from the SD card to the LCD display.
+ * Image reads go through a small LRU cache of SD card sectors, unless
+ * LCD_IMAGE_CACHE_SECTORS is 0.
  */
 
 #include <Adafruit_GFX.h>    // Core graphics library
@@ -8,6 +10,128 @@
 #include <SD.h>
 
 #include "lcd_image.h"
+#include "spi_stats.h"
+#include "lcd_capture.h"
+
+static uint32_t lcd_cache_hits = 0;
+static uint32_t lcd_cache_misses = 0;
+static uint32_t lcd_cache_evictions = 0;
+
+// Opens the image on the SD card if it is not open yet, returns false on errors
+static bool lcd_image_open(lcd_image_t *img, File *file)
+{
+  if (!*file && !(*file = SD.open(img->file_name))) {
+    Serial.print("File not found:'");
+    Serial.print(img->file_name);
+    Serial.println('\'');
+    return false;  // how do we inform the caller than things went wrong?
+  }
+  return true;
+}
+
+#if LCD_IMAGE_CACHE_SECTORS == 0
+
+// Reads length bytes of the image at pos from the card into buffer, returns false on errors
+static bool lcd_image_read(lcd_image_t *img, File *file, uint32_t pos,
+			   uint8_t *buffer, uint16_t length)
+{
+  lcd_cache_misses++;
+  if (!lcd_image_open(img, file)) {
+    return false;
+  }
+  file->seek(pos);
+  if (file->read(buffer, length) != length) {
+    Serial.println("SD Card Read Error!");
+    return false;
+  }
+  return true;
+}
+
+#else
+
+typedef struct {
+  char *file_name; // NULL for an unused entry
+  uint32_t sector;
+  uint16_t length; // bytes read, less than a sector at the end of a file
+  uint16_t last_use;
+  uint8_t data[LCD_IMAGE_SECTOR_SIZE];
+} lcd_sector_t;
+
+static lcd_sector_t lcd_sectors[LCD_IMAGE_CACHE_SECTORS];
+static uint16_t lcd_sector_clock = 0;
+
+// Returns the cached sector of the image, reading it from the card on a miss.
+// The file is only opened once a miss needs it. Returns NULL on errors.
+static lcd_sector_t *lcd_image_sector(lcd_image_t *img, File *file,
+				      uint32_t sector)
+{
+  lcd_sector_t *entry = &lcd_sectors[0];
+
+  lcd_sector_clock++;
+  for (uint8_t i = 0; i < LCD_IMAGE_CACHE_SECTORS; i++) {
+    if (lcd_sectors[i].file_name == img->file_name
+	&& lcd_sectors[i].sector == sector) {
+      lcd_cache_hits++;
+      lcd_sectors[i].last_use = lcd_sector_clock;
+      return &lcd_sectors[i];
+    }
+    // Otherwise remember an unused entry, or the least recently used one
+    if (entry->file_name != NULL
+	&& (lcd_sectors[i].file_name == NULL
+	    || (uint16_t) (lcd_sector_clock - lcd_sectors[i].last_use)
+	       > (uint16_t) (lcd_sector_clock - entry->last_use))) {
+      entry = &lcd_sectors[i];
+    }
+  }
+  lcd_cache_misses++;
+
+  // Open requested file on SD card if not already open
+  if (!lcd_image_open(img, file)) {
+    return NULL;
+  }
+
+  if (entry->file_name != NULL) {
+    lcd_cache_evictions++;
+  }
+  entry->file_name = NULL; // invalid until the read succeeds
+  file->seek(sector * LCD_IMAGE_SECTOR_SIZE);
+  int length = file->read(entry->data, LCD_IMAGE_SECTOR_SIZE);
+  if (length <= 0) {
+    Serial.println("SD Card Read Error!");
+    return NULL;
+  }
+  entry->file_name = img->file_name;
+  entry->sector = sector;
+  entry->length = length;
+  entry->last_use = lcd_sector_clock;
+  return entry;
+}
+
+// Copies length bytes of the image from pos into buffer, returns false on errors
+static bool lcd_image_read(lcd_image_t *img, File *file, uint32_t pos,
+			   uint8_t *buffer, uint16_t length)
+{
+  while (length > 0) {
+    lcd_sector_t *entry = lcd_image_sector(img, file, pos / LCD_IMAGE_SECTOR_SIZE);
+    uint16_t offset = pos % LCD_IMAGE_SECTOR_SIZE;
+
+    if (entry == NULL) {
+      return false;
+    }
+    if (offset >= entry->length) {
+      Serial.println("SD Card Read Error!"); // past the end of the file
+      return false;
+    }
+    uint16_t count = min(length, entry->length - offset);
+    memcpy(buffer, entry->data + offset, count);
+    buffer += count;
+    pos += count;
+    length -= count;
+  }
+  return true;
+}
+
+#endif
 
 /* Draws the referenced image to the LCD screen.
  *
@@ -22,32 +146,24 @@ void lcd_image_draw(lcd_image_t *img, Adafruit_ST7735 *tft,
 		    uint16_t scol, uint16_t srow, 
 		    uint16_t width, uint16_t height)
 {
-  File file;
-
-  // Open requested file on SD card if not already open
-  if ((file = SD.open(img->file_name)) == NULL) {
-    Serial.print("File not found:'");
-    Serial.print(img->file_name);
-    Serial.println('\'');
-    return;  // how do we inform the caller than things went wrong?
-  }
+  File file; // opened by the first cache miss
+  SPI_STATS_SCOPE("lcd_image_draw");
 
   // Setup display to receive window of pixels
   tft->setAddrWindow(scol, srow, scol+width-1, srow+height-1);
+  SPI_STATS_WINDOW((uint32_t) width * height);
+  LCD_CAPTURE_WINDOW(scol, srow, scol+width-1, srow+height-1);
 
   for (uint16_t row=0; row < height; row++) {
     uint16_t pixels[width];
 
-    // Seek to start of pixels to read from, need 32 bit arith for big images
+    // Start of pixels to read from, need 32 bit arith for big images
     uint32_t pos = ( (uint32_t) irow +  (uint32_t) row) *
       (2 *  (uint32_t) img->ncols) +  (uint32_t) icol * 2;
-    file.seek(pos);
 
     // Read row of pixels
-    if (file.read((uint8_t *) pixels, 2 * width) != 2 * width) {
-      Serial.println("SD Card Read Error!");
-      file.close();
-      return;
+    if (!lcd_image_read(img, &file, pos, (uint8_t *) pixels, 2 * width)) {
+      break;
     }
     
     // Send pixels to display
@@ -57,9 +173,23 @@ void lcd_image_draw(lcd_image_t *img, Adafruit_ST7735 *tft,
       // pixel bytes in reverse order on card
       pixel = (pixel << 8) | (pixel >> 8);
       tft->pushColor(pixel);
+      LCD_CAPTURE_PIXEL(pixel);
     }
   }
 
-  file.close();
+  if (file) {
+    file.close();
+  }
+}
+
+uint32_t lcd_image_cache_hits() {
+  return lcd_cache_hits;
 }
 
+uint32_t lcd_image_cache_misses() {
+  return lcd_cache_misses;
+}
+
+uint32_t lcd_image_cache_evictions() {
+  return lcd_cache_evictions;
+}
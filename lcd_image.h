@@ -1,10 +1,18 @@
 /*
  * Routine for drawing an image patch from the SD card to the LCD display.
+ * Image reads go through a small LRU cache of SD card sectors, each
+ * sector costs 522 bytes of SRAM. Build with LCD_IMAGE_CACHE_SECTORS=0
+ * to read the card directly, or more sectors to keep more of an image.
  */
 
 #ifndef _LCD_IMAGE_H
 #define _LCD_IMAGE_H
 
+#define LCD_IMAGE_SECTOR_SIZE 512
+#ifndef LCD_IMAGE_CACHE_SECTORS
+#define LCD_IMAGE_CACHE_SECTORS 1 // two rows of a 128 pixel wide image per sector, 0 for no cache
+#endif
+
 typedef struct {
   char *file_name;
   uint16_t ncols;
@@ -24,4 +32,13 @@ void lcd_image_draw(lcd_image_t *img, Adafruit_ST7735 *tft,
 		    uint16_t scol, uint16_t srow, 
 		    uint16_t width, uint16_t height);
 
+/* Number of sector reads served from the cache. */
+uint32_t lcd_image_cache_hits();
+
+/* Number of sector reads that went to the SD card. */
+uint32_t lcd_image_cache_misses();
+
+/* Number of cached sectors dropped to make room for another. */
+uint32_t lcd_image_cache_evictions();
+
 #endif
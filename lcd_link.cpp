@@ -0,0 +1,240 @@
+/*
+ * Display link between two boards. Drawing commands are batched by the
+ * board running the game and run by the board with the LCD display.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+
+#include "lcd_link.h"
+
+#define LCD_LINK_WIDTH 128
+#define LCD_LINK_HEIGHT 160
+
+static Stream *lcd_link_port = NULL;
+static uint8_t lcd_batch[LCD_LINK_MAX_BATCH]; // sending: queued commands, receiving: the batch arriving
+static uint8_t lcd_batch_len = 0;
+static uint8_t lcd_seq = 0; // sending: next batch, receiving: the batch expected next
+
+static uint8_t lcd_rx_state = 0; // receiving: 0 start, 1 seq, 2 len, 3 payload, 4 check
+static uint8_t lcd_rx_seq, lcd_rx_len, lcd_rx_check;
+static uint16_t lcd_dropped = 0;
+
+// Makes room for len more bytes in the batch
+static void lcd_link_reserve(uint8_t len) {
+  if (lcd_batch_len + len > LCD_LINK_MAX_BATCH) {
+    lcd_link_flush();
+  }
+}
+
+static void lcd_link_put16(uint16_t value) {
+  lcd_batch[lcd_batch_len++] = value;
+  lcd_batch[lcd_batch_len++] = value >> 8;
+}
+
+static uint16_t lcd_link_get16(uint8_t *data) {
+  return data[0] | (data[1] << 8);
+}
+
+void lcd_link_begin(Stream *port) {
+  lcd_link_port = port;
+  lcd_batch_len = 0;
+}
+
+void lcd_link_fill(int16_t x, int16_t y, int16_t w, int16_t h,
+		   uint16_t color) {
+  int16_t x1 = min(x + w, LCD_LINK_WIDTH);
+  int16_t y1 = min(y + h, LCD_LINK_HEIGHT);
+
+  x = max(x, 0);
+  y = max(y, 0);
+  if (x1 <= x || y1 <= y) {
+    return;
+  }
+  lcd_link_reserve(7);
+  lcd_batch[lcd_batch_len++] = LCD_LINK_FILL;
+  lcd_batch[lcd_batch_len++] = x;
+  lcd_batch[lcd_batch_len++] = y;
+  lcd_batch[lcd_batch_len++] = x1 - x;
+  lcd_batch[lcd_batch_len++] = y1 - y;
+  lcd_link_put16(color);
+}
+
+void lcd_link_char(int16_t x, int16_t y, uint8_t size, uint16_t color,
+		   uint16_t bg, uint8_t c) {
+  if (x < 0 || y < 0 || x >= LCD_LINK_WIDTH || y >= LCD_LINK_HEIGHT) {
+    return;
+  }
+  lcd_link_reserve(9);
+  lcd_batch[lcd_batch_len++] = LCD_LINK_CHAR;
+  lcd_batch[lcd_batch_len++] = x;
+  lcd_batch[lcd_batch_len++] = y;
+  lcd_batch[lcd_batch_len++] = size;
+  lcd_link_put16(color);
+  lcd_link_put16(bg);
+  lcd_batch[lcd_batch_len++] = c;
+}
+
+void lcd_link_call(uint8_t id, const uint8_t *data, uint8_t len) {
+  lcd_link_reserve(len + 3);
+  lcd_batch[lcd_batch_len++] = LCD_LINK_CALL;
+  lcd_batch[lcd_batch_len++] = id;
+  lcd_batch[lcd_batch_len++] = len;
+  memcpy(lcd_batch + lcd_batch_len, data, len);
+  lcd_batch_len += len;
+}
+
+void lcd_link_flush() {
+  uint8_t check = lcd_seq ^ lcd_batch_len;
+
+  if (lcd_link_port == NULL || lcd_batch_len == 0) {
+    return;
+  }
+  for (uint8_t i = 0; i < lcd_batch_len; i++) {
+    check ^= lcd_batch[i];
+  }
+  lcd_link_port->write(LCD_LINK_START);
+  lcd_link_port->write(lcd_seq++);
+  lcd_link_port->write(lcd_batch_len);
+  lcd_link_port->write(lcd_batch, lcd_batch_len);
+  lcd_link_port->write(check);
+  lcd_batch_len = 0;
+}
+
+/* Bytes the command at the start of a received batch takes.
+ *
+ * command : the command
+ * left    : bytes of the batch from the command on
+ * returns : 0 if the command is unknown or longer than the bytes left
+ */
+static uint8_t lcd_link_size(uint8_t *command, uint8_t left) {
+  uint16_t size;
+
+  switch (command[0]) {
+    case LCD_LINK_FILL:
+      size = 7;
+      break;
+    case LCD_LINK_CHAR:
+      size = 9;
+      break;
+    case LCD_LINK_CALL:
+      size = (left < 3) ? 0 : 3 + command[2];
+      break;
+    default:
+      size = 0;
+      break;
+  }
+  return (size > left) ? 0 : size;
+}
+
+// Runs the commands of a received batch, up to the first that doesn't fit in it
+static void lcd_link_run(Adafruit_ST7735 *tft, lcd_link_fn call) {
+  uint8_t i = 0;
+
+  while (i < lcd_rx_len) {
+    uint8_t *command = lcd_batch + i;
+    uint8_t size = lcd_link_size(command, lcd_rx_len - i);
+
+    if (size == 0) {
+      lcd_dropped++;
+      return; // the rest can't be read
+    }
+    switch (command[0]) {
+      case LCD_LINK_FILL:
+	tft->fillRect(command[1], command[2], command[3], command[4],
+		      lcd_link_get16(command + 5));
+	break;
+      case LCD_LINK_CHAR:
+	tft->drawChar(command[1], command[2], command[8],
+		      lcd_link_get16(command + 4), lcd_link_get16(command + 6),
+		      command[3]);
+	break;
+      case LCD_LINK_CALL:
+	call(command[1], command + 3, command[2]);
+	break;
+    }
+    i += size;
+  }
+}
+
+void lcd_link_receive(Adafruit_ST7735 *tft, lcd_link_fn call) {
+  while (lcd_link_port != NULL && lcd_link_port->available() > 0) {
+    uint8_t c = lcd_link_port->read();
+
+    switch (lcd_rx_state) {
+      case 0:
+	lcd_rx_state = (c == LCD_LINK_START) ? 1 : 0;
+	break;
+      case 1:
+	lcd_rx_seq = c;
+	lcd_rx_check = c;
+	lcd_rx_state = 2;
+	break;
+      case 2:
+	lcd_rx_len = c;
+	lcd_rx_check ^= c;
+	lcd_batch_len = 0;
+	lcd_rx_state = (c > LCD_LINK_MAX_BATCH) ? 0 : (c == 0) ? 4 : 3;
+	break;
+      case 3:
+	lcd_batch[lcd_batch_len++] = c;
+	lcd_rx_check ^= c;
+	if (lcd_batch_len == lcd_rx_len) {
+	  lcd_rx_state = 4;
+	}
+	break;
+      case 4:
+	lcd_rx_state = 0;
+	if (c != lcd_rx_check) {
+	  lcd_dropped++;
+	  break;
+	}
+	// Batches missing in between were lost
+	if (lcd_rx_seq != lcd_seq) {
+	  lcd_dropped += (uint8_t) (lcd_rx_seq - lcd_seq);
+	  Serial.print("Link lost batches before ");
+	  Serial.println(lcd_rx_seq);
+	}
+	lcd_seq = lcd_rx_seq + 1;
+	lcd_link_run(tft, call);
+	break;
+    }
+  }
+}
+
+uint16_t lcd_link_dropped() {
+  return lcd_dropped;
+}
+
+void lcd_link_tft::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  lcd_link_fill(x, y, 1, 1, color);
+}
+
+void lcd_link_tft::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  lcd_link_fill(x, y, 1, h, color);
+}
+
+void lcd_link_tft::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  lcd_link_fill(x, y, w, 1, color);
+}
+
+void lcd_link_tft::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  lcd_link_fill(x, y, w, h, color);
+}
+
+// Moves the cursor like Adafruit_GFX::write, the character is drawn on the display board
+size_t lcd_link_tft::write(uint8_t c) {
+  if (c == '\n') {
+    cursor_y += textsize * 8;
+    cursor_x = 0;
+  }
+  else if (c != '\r') {
+    lcd_link_char(cursor_x, cursor_y, textsize, textcolor, textbgcolor, c);
+    cursor_x += textsize * 6;
+    if (wrap && cursor_x > _width - textsize * 6) {
+      cursor_y += textsize * 8;
+      cursor_x = 0;
+    }
+  }
+  return 1;
+}
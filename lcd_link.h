@@ -0,0 +1,84 @@
+/*
+ * Display link between two boards. The board running the game draws with
+ * an lcd_link_tft, which batches drawing commands and sends them over a
+ * serial port, the board with the LCD display runs them with
+ * lcd_link_receive. Commands the game defines itself are sent with
+ * lcd_link_call and handed to a callback on the display board.
+ *
+ * Batch layout:
+ *   LCD_LINK_START seq len payload[len] check
+ * seq counts batches so lost ones are noticed, check is the XOR of seq,
+ * len and the payload. The payload is a list of commands:
+ *   LCD_LINK_FILL : x y w h (one byte each, on screen) colour (2 bytes)
+ *   LCD_LINK_CHAR : x y size colour (2 bytes) background (2 bytes) char
+ *   LCD_LINK_CALL : id len data[len]
+ * 2 byte values are sent low byte first. An unknown command, or one that
+ * runs past the end of its batch, drops the rest of the batch.
+ */
+
+#ifndef _LCD_LINK_H
+#define _LCD_LINK_H
+
+#define LCD_LINK_BAUD 500000 // exact on a 16 MHz Mega, 50 KB/s
+#define LCD_LINK_MAX_BATCH 200 // payload bytes per batch, a full batch is sent at once
+#define LCD_LINK_START 0xA5
+
+#define LCD_LINK_FILL 1
+#define LCD_LINK_CHAR 2
+#define LCD_LINK_CALL 3
+
+/* Runs a command sent with lcd_link_call.
+ *
+ * id   : the command
+ * data : its data
+ * len  : bytes of data
+ */
+typedef void (*lcd_link_fn)(uint8_t id, uint8_t *data, uint8_t len);
+
+/* Starts the link on a serial port that has been begun at LCD_LINK_BAUD. */
+void lcd_link_begin(Stream *port);
+
+/* Queues a filled rectangle, the part off the screen is dropped. */
+void lcd_link_fill(int16_t x, int16_t y, int16_t w, int16_t h,
+		   uint16_t color);
+
+/* Queues a character drawn like Adafruit_GFX::drawChar. */
+void lcd_link_char(int16_t x, int16_t y, uint8_t size, uint16_t color,
+		   uint16_t bg, uint8_t c);
+
+/* Queues a command for the display board's callback.
+ *
+ * id   : the command
+ * data : its data, at most LCD_LINK_MAX_BATCH - 3 bytes
+ * len  : bytes of data
+ */
+void lcd_link_call(uint8_t id, const uint8_t *data, uint8_t len);
+
+/* Sends the queued commands as one batch, if there are any. */
+void lcd_link_flush();
+
+/* Runs the commands of every batch that has fully arrived.
+ *
+ * tft  : the initialized tft struct
+ * call : runs the commands sent with lcd_link_call
+ */
+void lcd_link_receive(Adafruit_ST7735 *tft, lcd_link_fn call);
+
+/* Number of batches lost or received damaged. */
+uint16_t lcd_link_dropped();
+
+// Display that sends what the Adafruit_GFX drawing primitives and text
+// printing draw over the link instead of drawing it
+class lcd_link_tft : public Adafruit_ST7735 {
+ public:
+  lcd_link_tft(int8_t cs, int8_t dc, int8_t rst)
+    : Adafruit_ST7735(cs, dc, rst) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  size_t write(uint8_t c);
+};
+
+#endif
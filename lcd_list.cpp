@@ -0,0 +1,255 @@
+/*
+ * Display list, fills recorded by an lcd_list_tft and drawn once a frame.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+
+#include "lcd_list.h"
+
+struct lcd_fill_t {
+  uint8_t x, y, w, h;
+  uint16_t color;
+};
+
+static lcd_fill_t lcd_list[LCD_LIST_MAX];
+static uint8_t lcd_list_len = 0;
+
+// Single producer (commit) single consumer (drain) ring, each index is only written by its own side
+static lcd_fill_t lcd_queue[LCD_LIST_QUEUE];
+static uint8_t lcd_queue_head = 0; // next fill queued, written by commit
+static uint8_t lcd_queue_tail = 0; // next fill drawn, written by drain
+
+static uint16_t lcd_list_frames = 0;
+static uint32_t lcd_hidden_us = 0; // drawing done by drain
+static uint32_t lcd_exposed_us = 0; // drawing done by flush and commit
+static uint16_t lcd_stalls = 0; // fills commit waited for room for
+
+// True if a covers all of b
+static bool lcd_list_covers(lcd_fill_t *a, lcd_fill_t *b) {
+  return a->x <= b->x && a->y <= b->y
+	&& a->x + a->w >= b->x + b->w && a->y + a->h >= b->y + b->h;
+}
+
+// True if a and b share a pixel
+static bool lcd_list_overlaps(lcd_fill_t *a, lcd_fill_t *b) {
+  return a->x < b->x + b->w && b->x < a->x + a->w
+	&& a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+// True if a comes before b on the screen, top to bottom then left to right
+static bool lcd_list_before(lcd_fill_t *a, lcd_fill_t *b) {
+  return a->y < b->y || (a->y == b->y && a->x < b->x);
+}
+
+/* Merges b, drawn right after a, into a if the two make one rectangle of
+ * one color, or if b covers a.
+ *
+ * returns : true if b was merged
+ */
+static bool lcd_list_merge(lcd_fill_t *a, lcd_fill_t *b) {
+  if (lcd_list_covers(b, a)) {
+    *a = *b;
+    return true;
+  }
+  if (a->color != b->color) {
+    return false;
+  }
+  if (a->y == b->y && a->h == b->h
+	&& (a->x + a->w == b->x || b->x + b->w == a->x)) {
+    a->x = min(a->x, b->x);
+    a->w += b->w;
+    return true;
+  }
+  if (a->x == b->x && a->w == b->w
+	&& (a->y + a->h == b->y || b->y + b->h == a->y)) {
+    a->y = min(a->y, b->y);
+    a->h += b->h;
+    return true;
+  }
+  return false;
+}
+
+// Clips a fill to the screen and adds it to the list, a full list is drawn first
+static void lcd_list_add(lcd_list_tft *tft, int16_t x, int16_t y, int16_t w, int16_t h,
+	uint16_t color) {
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  w = min(w, tft->width() - x);
+  h = min(h, tft->height() - y);
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+
+  lcd_fill_t fill = {(uint8_t) x, (uint8_t) y, (uint8_t) w, (uint8_t) h, color};
+  // Text and lines come a pixel or a run at a time, most fills join the one before
+  if (lcd_list_len > 0 && lcd_list_merge(&lcd_list[lcd_list_len - 1], &fill)) {
+    return;
+  }
+  if (lcd_list_len == LCD_LIST_MAX) {
+    tft->flush();
+  }
+  lcd_list[lcd_list_len++] = fill;
+}
+
+void lcd_list_print(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint16_t color) {
+  Serial.print("fill ");
+  Serial.print(x);
+  Serial.print(' ');
+  Serial.print(y);
+  Serial.print(' ');
+  Serial.print(w);
+  Serial.print(' ');
+  Serial.print(h);
+  Serial.print(' ');
+  Serial.println(color, HEX);
+}
+
+void lcd_list_tft::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  lcd_list_add(this, x, y, 1, 1, color);
+}
+
+void lcd_list_tft::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  lcd_list_add(this, x, y, 1, h, color);
+}
+
+void lcd_list_tft::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  lcd_list_add(this, x, y, w, 1, color);
+}
+
+void lcd_list_tft::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  lcd_list_add(this, x, y, w, h, color);
+}
+
+// Drops the fills a later fill draws over, sorts the rest by screen position and merges them
+static void lcd_list_sort() {
+  uint8_t len = 0;
+
+  for (uint8_t i = 0; i < lcd_list_len; i++) {
+    uint8_t j = i + 1;
+    while (j < lcd_list_len && !lcd_list_covers(&lcd_list[j], &lcd_list[i])) {
+      j++;
+    }
+    if (j == lcd_list_len) {
+      lcd_list[len++] = lcd_list[i];
+    }
+  }
+
+  // A fill never moves past one it overlaps, so what ends up on top stays the same
+  for (uint8_t i = 1; i < len; i++) {
+    for (uint8_t k = i; k > 0 && lcd_list_before(&lcd_list[k], &lcd_list[k - 1])
+	&& !lcd_list_overlaps(&lcd_list[k], &lcd_list[k - 1]); k--) {
+      lcd_fill_t fill = lcd_list[k];
+      lcd_list[k] = lcd_list[k - 1];
+      lcd_list[k - 1] = fill;
+    }
+  }
+
+  // Merges the fills sorting brought next to each other
+  lcd_list_len = 0;
+  for (uint8_t i = 0; i < len; i++) {
+    if (lcd_list_len == 0 || !lcd_list_merge(&lcd_list[lcd_list_len - 1], &lcd_list[i])) {
+      lcd_list[lcd_list_len++] = lcd_list[i];
+    }
+  }
+}
+
+// Prints the drawing time per frame since the last report
+static void lcd_list_report() {
+  uint32_t frames = max(lcd_list_frames, 1);
+  uint32_t total = max(lcd_hidden_us + lcd_exposed_us, 1);
+
+  Serial.print("Display list per frame over ");
+  Serial.print(frames);
+  Serial.println(" frames:");
+  Serial.print("drawn while idle: ");
+  Serial.print(lcd_hidden_us / frames);
+  Serial.print(" us, within frames: ");
+  Serial.print(lcd_exposed_us / frames);
+  Serial.print(" us, hidden: ");
+  Serial.print(lcd_hidden_us * 100 / total);
+  Serial.print("%, waited for room: ");
+  Serial.print((double) lcd_stalls / frames, 1);
+  Serial.println(" fills");
+  lcd_list_frames = 0;
+  lcd_hidden_us = 0;
+  lcd_exposed_us = 0;
+  lcd_stalls = 0;
+}
+
+void lcd_list_tft::fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint16_t color) {
+  if (backend != NULL) {
+    backend(x, y, w, h, color);
+  }
+  else if (w == 1 && h == 1) {
+    lcd_capture_tft::drawPixel(x, y, color);
+  }
+  else {
+    lcd_capture_tft::fillRect(x, y, w, h, color);
+  }
+}
+
+void lcd_list_tft::flush() {
+  SPI_STATS_SCOPE("lcd_list");
+  uint32_t start = micros();
+
+  lcd_list_sort();
+  while (lcd_queue_tail != lcd_queue_head) {
+    lcd_fill_t *fill = &lcd_queue[lcd_queue_tail];
+    this->fill(fill->x, fill->y, fill->w, fill->h, fill->color);
+    lcd_queue_tail = (lcd_queue_tail + 1) & (LCD_LIST_QUEUE - 1);
+  }
+  for (uint8_t i = 0; i < lcd_list_len; i++) {
+    lcd_fill_t *fill = &lcd_list[i];
+    this->fill(fill->x, fill->y, fill->w, fill->h, fill->color);
+  }
+  lcd_list_len = 0;
+  lcd_exposed_us += micros() - start;
+}
+
+void lcd_list_tft::commit() {
+  SPI_STATS_SCOPE("lcd_list");
+  lcd_list_sort();
+  for (uint8_t i = 0; i < lcd_list_len; i++) {
+    uint8_t next = (lcd_queue_head + 1) & (LCD_LIST_QUEUE - 1);
+
+    // Back-pressure: drawing is a whole queue behind, the frame draws until there is room
+    if (next == lcd_queue_tail) {
+      uint32_t start = micros();
+      lcd_fill_t *fill = &lcd_queue[lcd_queue_tail];
+      this->fill(fill->x, fill->y, fill->w, fill->h, fill->color);
+      lcd_queue_tail = (lcd_queue_tail + 1) & (LCD_LIST_QUEUE - 1);
+      lcd_exposed_us += micros() - start;
+      lcd_stalls++;
+    }
+    lcd_queue[lcd_queue_head] = lcd_list[i];
+    lcd_queue_head = next;
+  }
+  lcd_list_len = 0;
+
+  if (++lcd_list_frames == LCD_LIST_FRAMES) {
+    lcd_list_report();
+  }
+}
+
+bool lcd_list_tft::drain(uint8_t count) {
+  if (lcd_queue_tail == lcd_queue_head) {
+    return false;
+  }
+  SPI_STATS_SCOPE("lcd_list");
+  uint32_t start = micros();
+
+  while (count-- > 0 && lcd_queue_tail != lcd_queue_head) {
+    lcd_fill_t *fill = &lcd_queue[lcd_queue_tail];
+    this->fill(fill->x, fill->y, fill->w, fill->h, fill->color);
+    lcd_queue_tail = (lcd_queue_tail + 1) & (LCD_LIST_QUEUE - 1);
+  }
+  lcd_hidden_us += micros() - start;
+  return lcd_queue_tail != lcd_queue_head;
+}
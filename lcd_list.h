@@ -0,0 +1,98 @@
+/*
+ * Display list. The Adafruit_GFX drawing primitives of an lcd_list_tft
+ * record fills in a list instead of drawing them, and the list is drawn
+ * once at the end of the frame. Before it is drawn, fills covered by a
+ * later fill are dropped, the list is sorted by screen position (top to
+ * bottom, then left to right) where that does not change which fill ends
+ * up on top, and touching fills of one color are merged into one.
+ *
+ * The list is drawn on the display through lcd_capture_tft, so FRAME_DUMP,
+ * FRAME_CHECK and SPI_STATS see what it draws, or handed to a recording
+ * back-end set with lcd_list_tft::record. Code that pushes pixels itself
+ * (setAddrWindow and pushColor) draws at once, so the list has to be
+ * drawn before it with LCD_LIST_FLUSH. The LCD_LIST_ macros compile to
+ * nothing unless DISPLAY_LIST is defined.
+ *
+ * Built with DISPLAY_LIST_PIPELINE as well, the list of a frame is queued
+ * when the frame ends and drawn a few fills at a time by LCD_LIST_IDLE
+ * while the game waits for its next frame, so drawing a frame overlaps
+ * the wait for the next. A frame that finds the queue full draws from it
+ * until its list fits. Every LCD_LIST_FRAMES frames the time spent
+ * drawing while idle (hidden) and within frames (not hidden) is printed.
+ */
+
+#ifndef _LCD_LIST_H
+#define _LCD_LIST_H
+
+#include "lcd_capture.h"
+
+#define LCD_LIST_MAX 48 // fills in the list, 6 bytes of SRAM each, a full list is drawn at once
+#define LCD_LIST_QUEUE 64 // fills queued for LCD_LIST_IDLE, a power of two, 6 bytes of SRAM each
+#define LCD_LIST_IDLE_FILLS 4 // fills drawn per LCD_LIST_IDLE
+#define LCD_LIST_FRAMES 64 // frames between reports
+
+/* Back-end the list is drawn with in place of the display.
+ *
+ * x, y  : top left corner of the fill, on the screen
+ * w, h  : size of the fill, at least 1
+ * color : 16-bit color of the fill
+ */
+typedef void (*lcd_list_fn)(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint16_t color);
+
+/* Recording back-end, prints every fill over Serial as
+ * "fill <x> <y> <w> <h> <color>".
+ */
+void lcd_list_print(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint16_t color);
+
+// Display that records what the Adafruit_GFX drawing primitives draw in the list
+class lcd_list_tft : public lcd_capture_tft {
+ public:
+  lcd_list_tft(int8_t cs, int8_t dc, int8_t rst)
+    : lcd_capture_tft(cs, dc, rst), backend(NULL) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+  /* Sends the list to fn from now on, NULL for the display. */
+  void record(lcd_list_fn fn) { backend = fn; }
+
+  /* Drops covered fills, sorts and merges the list, draws what is queued
+   * and then the list, and empties the list.
+   */
+  void flush();
+
+  /* Ends a frame: drops covered fills, sorts and merges the list and
+   * queues it for drain, drawing from the queue first while it is full.
+   * Every LCD_LIST_FRAMES frames the drawing times are printed.
+   */
+  void commit();
+
+  /* Draws up to count fills from the queue.
+   *
+   * returns : true if fills are left in the queue
+   */
+  bool drain(uint8_t count);
+
+ private:
+  lcd_list_fn backend;
+
+  void fill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint16_t color);
+};
+
+#if defined(DISPLAY_LIST) && defined(DISPLAY_LIST_PIPELINE)
+#define LCD_LIST_FLUSH(tft) (tft).flush()
+#define LCD_LIST_FRAME_END(tft) (tft).commit()
+#define LCD_LIST_IDLE(tft) (tft).drain(LCD_LIST_IDLE_FILLS)
+#elif defined(DISPLAY_LIST)
+#define LCD_LIST_FLUSH(tft) (tft).flush()
+#define LCD_LIST_FRAME_END(tft) (tft).flush()
+#define LCD_LIST_IDLE(tft)
+#else
+#define LCD_LIST_FLUSH(tft)
+#define LCD_LIST_FRAME_END(tft)
+#define LCD_LIST_IDLE(tft)
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Routines for drawing an image stored as a tile map from flash to the
+ * LCD display.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+
+#include "lcd_tiles.h"
+#include "spi_stats.h"
+#include "lcd_capture.h"
+
+// Colour of the image pixel at icol, irow
+static uint16_t lcd_tiles_pixel(lcd_tiles_t *tiles, uint16_t icol, uint16_t irow) {
+  uint16_t tile_cols = (tiles->ncols + LCD_TILE_SIZE - 1) / LCD_TILE_SIZE;
+  uint8_t tile = pgm_read_byte(tiles->map + (irow / LCD_TILE_SIZE) * tile_cols
+			       + icol / LCD_TILE_SIZE);
+  uint8_t bits = pgm_read_byte(tiles->atlas + (uint16_t) tile * LCD_TILE_SIZE
+			       + irow % LCD_TILE_SIZE);
+
+  return tiles->palette[(bits >> (2 * (icol % LCD_TILE_SIZE))) & 3];
+}
+
+void lcd_tiles_row(lcd_tiles_t *tiles, uint16_t *line,
+		   uint16_t icol, uint16_t irow, uint16_t width)
+{
+  for (uint16_t col = 0; col < width; col++) {
+    line[col] = lcd_tiles_pixel(tiles, icol + col, irow);
+  }
+}
+
+void lcd_tiles_draw(lcd_tiles_t *tiles, Adafruit_ST7735 *tft,
+		    uint16_t icol, uint16_t irow,
+		    uint16_t scol, uint16_t srow,
+		    uint16_t width, uint16_t height)
+{
+  SPI_STATS_SCOPE("lcd_tiles_draw");
+
+  // Setup display to receive window of pixels
+  tft->setAddrWindow(scol, srow, scol+width-1, srow+height-1);
+  SPI_STATS_WINDOW((uint32_t) width * height);
+  LCD_CAPTURE_WINDOW(scol, srow, scol+width-1, srow+height-1);
+
+  for (uint16_t row = 0; row < height; row++) {
+    for (uint16_t col = 0; col < width; col++) {
+      uint16_t pixel = lcd_tiles_pixel(tiles, icol + col, irow + row);
+
+      tft->pushColor(pixel);
+      LCD_CAPTURE_PIXEL(pixel);
+    }
+  }
+}
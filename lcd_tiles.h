@@ -0,0 +1,43 @@
+/*
+ * Routines for drawing an image stored as a tile map from flash to the
+ * LCD display. Every LCD_TILE_SIZE x LCD_TILE_SIZE block of the image is
+ * an index into a tile atlas, every atlas pixel a 2 bit palette index.
+ */
+
+#ifndef _LCD_TILES_H
+#define _LCD_TILES_H
+
+#define LCD_TILE_SIZE 4 // pixels per tile side, one atlas byte per tile row
+
+typedef struct {
+  const uint8_t *map;      // tile indices in PROGMEM, row by row
+  const uint8_t *atlas;    // tiles in PROGMEM, LCD_TILE_SIZE bytes each
+  const uint16_t *palette; // the 4 colours of the atlas pixels
+  uint16_t ncols;
+  uint16_t nrows;
+} lcd_tiles_t;
+
+/* Fills line with width pixels of one image row.
+ *
+ * tiles      : the image to read
+ * line       : receives the pixel colours
+ * icol, irow : the leftmost pixel of the row to read
+ * width      : the number of pixels read
+ */
+void lcd_tiles_row(lcd_tiles_t *tiles, uint16_t *line,
+		   uint16_t icol, uint16_t irow, uint16_t width);
+
+/* Draws the referenced image to the LCD screen.
+ *
+ * tiles         : the image to draw
+ * tft           : the initialized tft struct
+ * icol, irow    : the upper-left corner of the image patch to draw
+ * scol, srow    : the upper-left corner of the screen to draw to
+ * width, height : controls the size of the patch drawn.
+ */
+void lcd_tiles_draw(lcd_tiles_t *tiles, Adafruit_ST7735 *tft,
+		    uint16_t icol, uint16_t irow,
+		    uint16_t scol, uint16_t srow,
+		    uint16_t width, uint16_t height);
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Retained-mode widgets (labels and numbers) for the menu screens.
+ * Only widgets marked dirty are sent to the LCD display.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+
+#include "lcd_widget.h"
+#include "spi_stats.h"
+
+/* Draws a single widget and marks it clean.
+ *
+ * widget : the widget to draw
+ * tft    : the initialized tft struct
+ */
+void lcd_widget_draw(lcd_widget_t *widget, Adafruit_ST7735 *tft)
+{
+  SPI_STATS_SCOPE("lcd_widget_draw");
+
+  // Text is printed with a background colour so the old text is
+  // overwritten in the same pass, no separate erase is needed
+  if (widget->selected) {
+    tft->setTextColor(ST7735_BLACK, ST7735_WHITE);
+  }
+  else {
+    tft->setTextColor(ST7735_WHITE, ST7735_BLACK);
+  }
+  tft->setTextSize(widget->text_size);
+  tft->setCursor(widget->x, widget->y);
+
+  if (widget->text != NULL) {
+    tft->print(widget->text);
+  }
+  else {
+    tft->print(*widget->value);
+  }
+
+  if (widget->underline) {
+    tft->drawLine(widget->x - 1, widget->y + widget->h,
+		  widget->x - 1 + widget->w, widget->y + widget->h,
+		  ST7735_WHITE);
+  }
+
+  widget->dirty = false;
+}
+
+/* Draws every dirty widget in the list.
+ *
+ * widgets : the widget list
+ * count   : number of widgets in the list
+ * tft     : the initialized tft struct
+ */
+void lcd_widgets_draw(lcd_widget_t *widgets, uint8_t count,
+		      Adafruit_ST7735 *tft)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    if (widgets[i].dirty) {
+      lcd_widget_draw(&widgets[i], tft);
+    }
+  }
+}
+
+/* Fills the bounds of every widget in the list with color and marks
+ * them dirty, so they are redrawn in full the next time they are shown.
+ *
+ * widgets : the widget list
+ * count   : number of widgets in the list
+ * tft     : the initialized tft struct
+ * color   : the background color to fill with
+ */
+void lcd_widgets_clear(lcd_widget_t *widgets, uint8_t count,
+		       Adafruit_ST7735 *tft, uint16_t color)
+{
+  for (uint8_t i = 0; i < count; i++) {
+    lcd_widget_t *widget = &widgets[i];
+
+    if (widget->underline) {
+      // underline starts one pixel left of the text and sits below it
+      tft->fillRect(widget->x - 1, widget->y, widget->w + 1, widget->h + 1,
+		    color);
+    }
+    else {
+      tft->fillRect(widget->x, widget->y, widget->w, widget->h, color);
+    }
+    widget->dirty = true;
+  }
+}
@@ -0,0 +1,47 @@
+/*
+ * Retained-mode widgets (labels and numbers) for the menu screens.
+ * Only widgets marked dirty are sent to the LCD display.
+ */
+
+#ifndef _LCD_WIDGET_H
+#define _LCD_WIDGET_H
+
+typedef struct {
+  uint8_t x, y;       // upper-left corner of the text on screen
+  uint8_t w, h;       // size of the text in pixels
+  uint8_t text_size;  // Adafruit_GFX text size
+  const char *text;   // label to print, NULL to print *value instead
+  int *value;         // number to print when text is NULL
+  bool underline;     // draws a line one pixel under the text
+  bool selected;      // drawn with inverted (black on white) colours
+  bool dirty;         // needs to be redrawn
+} lcd_widget_t;
+
+/* Draws a single widget and marks it clean.
+ *
+ * widget : the widget to draw
+ * tft    : the initialized tft struct
+ */
+void lcd_widget_draw(lcd_widget_t *widget, Adafruit_ST7735 *tft);
+
+/* Draws every dirty widget in the list.
+ *
+ * widgets : the widget list
+ * count   : number of widgets in the list
+ * tft     : the initialized tft struct
+ */
+void lcd_widgets_draw(lcd_widget_t *widgets, uint8_t count,
+		      Adafruit_ST7735 *tft);
+
+/* Fills the bounds of every widget in the list with color and marks
+ * them dirty, so they are redrawn in full the next time they are shown.
+ *
+ * widgets : the widget list
+ * count   : number of widgets in the list
+ * tft     : the initialized tft struct
+ * color   : the background color to fill with
+ */
+void lcd_widgets_clear(lcd_widget_t *widgets, uint8_t count,
+		       Adafruit_ST7735 *tft, uint16_t color);
+
+#endif
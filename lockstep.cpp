@@ -0,0 +1,393 @@
+/*
+ * Two player games over a serial link. Both boards run the whole game and
+ * only send each other their joystick input, the frames are kept in step
+ * by waiting for the other board's input.
+ */
+
+#include <Arduino.h>
+
+#include "lockstep.h"
+
+#define LOCKSTEP_START 'S'
+#define LOCKSTEP_SEED 'N'
+#define LOCKSTEP_INPUT 'I'
+#define LOCKSTEP_STATE 'R'
+#define LOCKSTEP_JOIN 'J'
+
+#define LOCKSTEP_OFF 0
+#define LOCKSTEP_HOST 1
+#define LOCKSTEP_GUEST 2
+
+#define LOCKSTEP_MASK (LOCKSTEP_WINDOW - 1)
+#define LOCKSTEP_HASHED 0x80
+
+static Stream *lockstep_port = NULL;
+static uint8_t *lockstep_state; // where the host's state is received
+static uint16_t lockstep_state_size;
+
+static uint8_t lockstep_role = LOCKSTEP_OFF;
+static uint16_t lockstep_frame; // next frame to play
+static uint16_t lockstep_sent; // next frame to send this board's input for
+static uint8_t lockstep_resyncs; // states sent by the host, bits 4-6 of every input
+static bool lockstep_desync;
+static bool lockstep_state_in; // a state arrived since lockstep_resynced
+static bool lockstep_waiting; // the frame waits for the other board's input
+static unsigned long lockstep_wait_start;
+
+// Inputs and hashes of the frames around lockstep_frame, index frame & LOCKSTEP_MASK
+static uint8_t lockstep_local_input[LOCKSTEP_WINDOW];
+static uint8_t lockstep_remote_input[LOCKSTEP_WINDOW];
+static uint16_t lockstep_remote_frame[LOCKSTEP_WINDOW]; // frame of each remote input
+static uint16_t lockstep_local_hash[LOCKSTEP_WINDOW];
+static uint16_t lockstep_local_hash_frame[LOCKSTEP_WINDOW];
+static uint16_t lockstep_remote_hash[LOCKSTEP_WINDOW];
+static uint16_t lockstep_remote_hash_frame[LOCKSTEP_WINDOW];
+
+// Packet being received
+static uint8_t lockstep_rx_type = 0; // 0 between packets
+static uint8_t lockstep_rx[LOCKSTEP_MAX_SETTINGS + 2]; // bytes after the type, except a state
+static uint16_t lockstep_rx_len; // bytes after the type received
+static uint16_t lockstep_rx_need; // bytes after the type expected
+static uint8_t lockstep_rx_check;
+static bool lockstep_start_in; // a START packet arrived
+static bool lockstep_join_in; // a JOIN packet arrived
+static uint8_t lockstep_settings[LOCKSTEP_MAX_SETTINGS + 1]; // count and settings of the last START
+static bool lockstep_seed_in; // a SEED packet arrived
+static uint32_t lockstep_rx_seed;
+
+static uint16_t lockstep_get16(uint8_t *data) {
+  return data[0] | (data[1] << 8);
+}
+
+// Sends a packet, the check is added after it
+static void lockstep_send(uint8_t type, uint8_t *data, uint8_t len) {
+  uint8_t check = 0;
+
+  for (uint8_t i = 0; i < len; i++) {
+    check ^= data[i];
+  }
+  lockstep_port->write(type);
+  lockstep_port->write(data, len);
+  lockstep_port->write(check);
+}
+
+// Starts a game at frame 0, the inputs of the first LOCKSTEP_DELAY frames are centred
+static void lockstep_reset(uint8_t role) {
+  lockstep_role = role;
+  lockstep_frame = 0;
+  lockstep_sent = LOCKSTEP_DELAY;
+  lockstep_resyncs = 0;
+  lockstep_desync = false;
+  lockstep_state_in = false;
+  lockstep_waiting = false;
+  for (uint8_t i = 0; i < LOCKSTEP_WINDOW; i++) {
+    lockstep_local_input[i] = 0;
+    lockstep_remote_input[i] = 0;
+    lockstep_remote_frame[i] = (i < LOCKSTEP_DELAY) ? i : 0xFFFF;
+    lockstep_local_hash_frame[i] = 0xFFFF;
+    lockstep_remote_hash_frame[i] = 0xFFFF;
+  }
+}
+
+// Compares the hashes of a frame once both boards' are in
+static void lockstep_compare(uint16_t frame) {
+  uint8_t slot = frame & LOCKSTEP_MASK;
+
+  if (lockstep_desync || lockstep_local_hash_frame[slot] != frame
+      || lockstep_remote_hash_frame[slot] != frame) {
+    return;
+  }
+  if (lockstep_local_hash[slot] != lockstep_remote_hash[slot]) {
+    lockstep_desync = true;
+    Serial.print("Lockstep desync before frame ");
+    Serial.println(frame);
+  }
+}
+
+// Handles a received packet whose check matched
+static void lockstep_packet() {
+  switch (lockstep_rx_type) {
+    case LOCKSTEP_START:
+      // Kept apart from lockstep_rx, the SEED sent right after it may arrive before they are read
+      memcpy(lockstep_settings, lockstep_rx, 1 + lockstep_rx[0]);
+      lockstep_start_in = true;
+      lockstep_seed_in = false; // a seed from before belongs to another game
+      break;
+    case LOCKSTEP_JOIN:
+      lockstep_join_in = true;
+      break;
+    case LOCKSTEP_SEED:
+      lockstep_rx_seed = lockstep_get16(lockstep_rx)
+	| ((uint32_t) lockstep_get16(lockstep_rx + 2) << 16);
+      lockstep_seed_in = true;
+      break;
+    case LOCKSTEP_INPUT: {
+      if (lockstep_role == LOCKSTEP_OFF) {
+	break;
+      }
+      // Full frame number from its low byte, it is within a few frames of this board's
+      uint16_t frame = lockstep_frame + (int8_t) (lockstep_rx[0] - (uint8_t) lockstep_frame);
+      uint8_t slot = frame & LOCKSTEP_MASK;
+      lockstep_remote_input[slot] = lockstep_rx[1] & 0x0F;
+      lockstep_remote_frame[slot] = frame;
+      // Hashes from before the last resync no longer match this board's
+      if ((lockstep_rx[1] & LOCKSTEP_HASHED) && ((lockstep_rx[1] >> 4) & 7) == lockstep_resyncs) {
+	frame -= LOCKSTEP_DELAY;
+	slot = frame & LOCKSTEP_MASK;
+	lockstep_remote_hash[slot] = lockstep_get16(lockstep_rx + 2);
+	lockstep_remote_hash_frame[slot] = frame;
+	lockstep_compare(frame);
+      }
+      break;
+    }
+    case LOCKSTEP_STATE:
+      if (lockstep_role != LOCKSTEP_GUEST || lockstep_get16(lockstep_rx + 3) != lockstep_state_size) {
+	break;
+      }
+      // The guest continues from the host's frame, its own hashes since then are of the old state
+      lockstep_resyncs = lockstep_rx[0];
+      lockstep_frame = lockstep_get16(lockstep_rx + 1);
+      for (uint8_t i = 0; i < LOCKSTEP_WINDOW; i++) {
+	lockstep_local_hash_frame[i] = 0xFFFF;
+	lockstep_remote_hash_frame[i] = 0xFFFF;
+      }
+      lockstep_desync = false;
+      lockstep_waiting = false;
+      lockstep_state_in = true;
+      break;
+  }
+}
+
+// Receives every byte that has arrived
+static void lockstep_poll() {
+  while (lockstep_port != NULL && lockstep_port->available() > 0) {
+    uint8_t c = lockstep_port->read();
+
+    if (lockstep_rx_type == 0) {
+      lockstep_rx_type = c;
+      lockstep_rx_len = 0;
+      lockstep_rx_check = 0;
+      switch (c) {
+	case LOCKSTEP_START:
+	  lockstep_rx_need = 1;
+	  break;
+	case LOCKSTEP_JOIN:
+	  lockstep_rx_need = 0;
+	  break;
+	case LOCKSTEP_SEED:
+	case LOCKSTEP_INPUT:
+	  lockstep_rx_need = 4;
+	  break;
+	case LOCKSTEP_STATE:
+	  lockstep_rx_need = 5; // the header, the state's size is in it
+	  break;
+	default:
+	  lockstep_rx_type = 0; // not the start of a packet
+      }
+      continue;
+    }
+    // The last byte is the check
+    if (lockstep_rx_len == lockstep_rx_need) {
+      if (c == lockstep_rx_check) {
+	lockstep_packet();
+      }
+      lockstep_rx_type = 0;
+      continue;
+    }
+    lockstep_rx_check ^= c;
+    if (lockstep_rx_type == LOCKSTEP_STATE && lockstep_rx_len >= 5) {
+      if (lockstep_rx_need == 5 + lockstep_state_size) {
+	lockstep_state[lockstep_rx_len - 5] = c;
+      }
+    }
+    else {
+      lockstep_rx[lockstep_rx_len] = c;
+    }
+    lockstep_rx_len++;
+    // Lengths that follow a header
+    if (lockstep_rx_type == LOCKSTEP_START && lockstep_rx_len == 1) {
+      if (c > LOCKSTEP_MAX_SETTINGS) {
+	lockstep_rx_type = 0;
+      }
+      lockstep_rx_need = 1 + c;
+    }
+    else if (lockstep_rx_type == LOCKSTEP_STATE && lockstep_rx_len == 5) {
+      lockstep_rx_need = 5 + lockstep_get16(lockstep_rx + 3);
+    }
+  }
+}
+
+void lockstep_begin(Stream *port, void *state, uint16_t size) {
+  lockstep_port = port;
+  lockstep_state = (uint8_t *) state;
+  lockstep_state_size = size;
+  lockstep_role = LOCKSTEP_OFF;
+}
+
+bool lockstep_active() {
+  return lockstep_role != LOCKSTEP_OFF;
+}
+
+bool lockstep_guest() {
+  return lockstep_role == LOCKSTEP_GUEST;
+}
+
+void lockstep_host(int *settings, uint8_t count) {
+  uint8_t data[LOCKSTEP_MAX_SETTINGS + 1];
+
+  if (lockstep_port == NULL) {
+    return;
+  }
+  data[0] = count;
+  for (uint8_t i = 0; i < count; i++) {
+    data[1 + i] = settings[i];
+  }
+  lockstep_join_in = false;
+  lockstep_send(LOCKSTEP_START, data, 1 + count);
+
+  // Without a board on the main menu to join, the game is played alone right away
+  unsigned long start = millis();
+  while (!lockstep_join_in) {
+    lockstep_poll();
+    if (millis() - start > LOCKSTEP_JOIN_TIMEOUT) {
+      Serial.println("Lockstep: no board joined, the game is played alone");
+      return;
+    }
+  }
+  lockstep_reset(LOCKSTEP_HOST);
+}
+
+bool lockstep_joined(int *settings, uint8_t count) {
+  lockstep_poll();
+  if (!lockstep_start_in) {
+    return false;
+  }
+  lockstep_start_in = false;
+  for (uint8_t i = 0; i < count && i < lockstep_settings[0]; i++) {
+    settings[i] = lockstep_settings[1 + i];
+  }
+  lockstep_send(LOCKSTEP_JOIN, NULL, 0);
+  lockstep_reset(LOCKSTEP_GUEST);
+  return true;
+}
+
+uint32_t lockstep_seed(uint32_t seed) {
+  if (lockstep_role == LOCKSTEP_HOST) {
+    uint8_t data[4] = {(uint8_t) seed, (uint8_t) (seed >> 8),
+		       (uint8_t) (seed >> 16), (uint8_t) (seed >> 24)};
+    lockstep_send(LOCKSTEP_SEED, data, 4);
+  }
+  else if (lockstep_role == LOCKSTEP_GUEST) {
+    unsigned long start = millis();
+    while (!lockstep_seed_in) {
+      lockstep_poll();
+      if (millis() - start > LOCKSTEP_TIMEOUT) {
+	Serial.println("Lockstep lost waiting for the level seed");
+	lockstep_end();
+	return seed;
+      }
+    }
+    lockstep_seed_in = false;
+    seed = lockstep_rx_seed;
+  }
+  return seed;
+}
+
+bool lockstep_input(uint8_t input, uint16_t (*hash)(), uint8_t *host,
+		    uint8_t *guest) {
+  uint8_t slot = lockstep_frame & LOCKSTEP_MASK;
+
+  if (lockstep_role == LOCKSTEP_OFF) {
+    *host = *guest = input;
+    return true;
+  }
+  lockstep_poll();
+  // Sends the input for frame + LOCKSTEP_DELAY, and for any frames a resync skipped
+  while (lockstep_sent <= lockstep_frame + LOCKSTEP_DELAY) {
+    uint8_t data[4] = {(uint8_t) lockstep_sent,
+		       (uint8_t) (input | (lockstep_resyncs << 4)), 0, 0};
+    if (lockstep_sent == lockstep_frame + LOCKSTEP_DELAY) {
+      uint16_t value = hash();
+      data[1] |= LOCKSTEP_HASHED;
+      data[2] = value;
+      data[3] = value >> 8;
+      lockstep_local_hash[slot] = value;
+      lockstep_local_hash_frame[slot] = lockstep_frame;
+      lockstep_compare(lockstep_frame);
+    }
+    lockstep_local_input[lockstep_sent & LOCKSTEP_MASK] = input;
+    lockstep_send(LOCKSTEP_INPUT, data, 4);
+    lockstep_sent++;
+  }
+  // Waits for the other board's input
+  if (lockstep_remote_frame[slot] != lockstep_frame) {
+    if (!lockstep_waiting) {
+      lockstep_waiting = true;
+      lockstep_wait_start = millis();
+    }
+    else if (millis() - lockstep_wait_start > LOCKSTEP_TIMEOUT) {
+      Serial.println("Lockstep lost, the game goes on alone");
+      lockstep_end();
+      *host = *guest = input;
+      return true;
+    }
+    return false;
+  }
+  lockstep_waiting = false;
+  if (lockstep_role == LOCKSTEP_HOST) {
+    *host = lockstep_local_input[slot];
+    *guest = lockstep_remote_input[slot];
+  }
+  else {
+    *host = lockstep_remote_input[slot];
+    *guest = lockstep_local_input[slot];
+  }
+  lockstep_frame++;
+  return true;
+}
+
+bool lockstep_desynced() {
+  return lockstep_role == LOCKSTEP_HOST && lockstep_desync;
+}
+
+void lockstep_resync() {
+  uint8_t check;
+
+  if (lockstep_role != LOCKSTEP_HOST) {
+    return;
+  }
+  // Hashes from the guest before it takes the state are ignored
+  lockstep_resyncs = (lockstep_resyncs + 1) & 7;
+  for (uint8_t i = 0; i < LOCKSTEP_WINDOW; i++) {
+    lockstep_remote_hash_frame[i] = 0xFFFF;
+  }
+  lockstep_desync = false;
+
+  uint8_t header[5] = {lockstep_resyncs, (uint8_t) lockstep_frame,
+		       (uint8_t) (lockstep_frame >> 8), (uint8_t) lockstep_state_size,
+		       (uint8_t) (lockstep_state_size >> 8)};
+  check = 0;
+  for (uint8_t i = 0; i < 5; i++) {
+    check ^= header[i];
+  }
+  for (uint16_t i = 0; i < lockstep_state_size; i++) {
+    check ^= lockstep_state[i];
+  }
+  lockstep_port->write(LOCKSTEP_STATE);
+  lockstep_port->write(header, 5);
+  lockstep_port->write(lockstep_state, lockstep_state_size);
+  lockstep_port->write(check);
+}
+
+bool lockstep_resynced() {
+  lockstep_poll();
+  if (!lockstep_state_in) {
+    return false;
+  }
+  lockstep_state_in = false;
+  return true;
+}
+
+void lockstep_end() {
+  lockstep_role = LOCKSTEP_OFF;
+}
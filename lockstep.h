@@ -0,0 +1,103 @@
+/*
+ * Two player games over a serial link. Both boards run the whole game and
+ * only send each other their joystick input, LOCKSTEP_DELAY frames before
+ * it is played, so a frame runs as soon as the input of both boards for it
+ * is in. The board that starts the game (the host) plays PacMan, the other
+ * board (the guest) plays a ghost.
+ *
+ * Every input carries a hash of the sender's game state. When the hashes
+ * of a frame differ the boards have gone apart, and the host sends its
+ * state for the guest to take over.
+ *
+ * Packets, a type byte followed by (2 byte values are sent low byte first):
+ *   START : count settings[count] check
+ *   JOIN  : check
+ *           the guest's answer to START, the host waits for it
+ *   SEED  : seed (4 bytes) check
+ *   INPUT : frame input hash (2 bytes) check
+ *           frame is the low byte of the frame the input is played in,
+ *           input holds the input (bits 0-3), the number of resyncs
+ *           (bits 4-6) and whether hash is set (bit 7), hash is of the
+ *           state before frame - LOCKSTEP_DELAY
+ *   STATE : resyncs frame (2 bytes) size (2 bytes) state[size] check
+ *           state is the host's before it plays frame
+ * check is the XOR of the bytes between the type and the check.
+ */
+
+#ifndef _LOCKSTEP_H
+#define _LOCKSTEP_H
+
+#define LOCKSTEP_BAUD 115200
+#define LOCKSTEP_DELAY 3 // frames between reading an input and playing it, covers the link latency
+#define LOCKSTEP_WINDOW 8 // frames of inputs and hashes kept, a power of 2 over 2 * LOCKSTEP_DELAY
+#define LOCKSTEP_TIMEOUT 2000 // millis without the other board's input before the link counts as lost
+#define LOCKSTEP_JOIN_TIMEOUT 250 // millis the host waits for the guest to answer START
+#define LOCKSTEP_MAX_SETTINGS 8
+
+/* Starts listening on a serial port that has been begun at LOCKSTEP_BAUD.
+ *
+ * port  : the serial port wired to the other board
+ * state : where a state sent by the host is received
+ * size  : size of the state
+ */
+void lockstep_begin(Stream *port, void *state, uint16_t size);
+
+/* True during a two player game. */
+bool lockstep_active();
+
+/* True during a two player game started by the other board. */
+bool lockstep_guest();
+
+/* Starts a two player game as the host, sending the game settings. The
+ * game is only played in lockstep once the other board has answered
+ * within LOCKSTEP_JOIN_TIMEOUT, otherwise it is played alone.
+ *
+ * settings : the settings array, values 0-255
+ * count    : number of settings, at most LOCKSTEP_MAX_SETTINGS
+ */
+void lockstep_host(int *settings, uint8_t count);
+
+/* Checks whether the other board has started a two player game, and if so
+ * starts it here as the guest.
+ *
+ * settings : replaced with the host's settings
+ * count    : number of settings
+ * returns  : true once, when the game starts
+ */
+bool lockstep_joined(int *settings, uint8_t count);
+
+/* Sends the random seed of a level as the host, or waits for the host's
+ * seed as the guest. Returns seed otherwise.
+ */
+uint32_t lockstep_seed(uint32_t seed);
+
+/* Called every frame with the joystick input (0-15) until it returns true.
+ * The first call of a frame sends input for frame + LOCKSTEP_DELAY.
+ *
+ * input   : the input read from the joystick
+ * hash    : computes a hash of the game state
+ * host    : set to the host's input for the frame
+ * guest   : set to the guest's input for the frame
+ * returns : false while the other board's input for the frame is missing,
+ *           the frame must not run yet
+ */
+bool lockstep_input(uint8_t input, uint16_t (*hash)(), uint8_t *host,
+		    uint8_t *guest);
+
+/* True on the host when the boards have gone apart, it should put its
+ * state where lockstep_begin was told and call lockstep_resync.
+ */
+bool lockstep_desynced();
+
+/* Sends the host's state to the guest. */
+void lockstep_resync();
+
+/* True once on the guest after a state from the host has arrived, it
+ * should restore the game from it.
+ */
+bool lockstep_resynced();
+
+/* Ends the two player game. */
+void lockstep_end();
+
+#endif
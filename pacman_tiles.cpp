@@ -0,0 +1,140 @@
+/*
+ * Tile map of the PacMan maze (Pac-man.lcd reduced to black, wall and dot
+ * pixels), drawn with lcd_tiles.
+ */
+
+#include <Arduino.h>
+
+#include "pacman_tiles.h"
+
+// Tile index of every 4x4 block of the 128x142 maze, the last tile row is half empty
+const uint8_t pacManTileMap[1152] PROGMEM = {
+  0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02,
+  0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x04,
+  0x05, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0A, 0x0B, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0C,
+  0x0C, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0A, 0x0B, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0D,
+  0x05, 0x0E, 0x0F, 0x10, 0x10, 0x10, 0x0F, 0x11, 0x12, 0x10, 0x10, 0x10, 0x10, 0x0F, 0x13, 0x0C,
+  0x0C, 0x0E, 0x0F, 0x10, 0x10, 0x10, 0x10, 0x14, 0x11, 0x0F, 0x10, 0x10, 0x10, 0x0F, 0x13, 0x0D,
+  0x05, 0x15, 0x16, 0x17, 0x18, 0x18, 0x19, 0x11, 0x1A, 0x18, 0x18, 0x18, 0x1B, 0x1C, 0x13, 0x0C,
+  0x0C, 0x0E, 0x1D, 0x17, 0x18, 0x18, 0x18, 0x1E, 0x11, 0x1F, 0x18, 0x18, 0x1B, 0x20, 0x21, 0x0D,
+  0x05, 0x22, 0x23, 0x24, 0x10, 0x25, 0x26, 0x27, 0x28, 0x29, 0x10, 0x10, 0x2A, 0x1C, 0x2B, 0x0C,
+  0x0C, 0x2C, 0x1D, 0x24, 0x10, 0x10, 0x2D, 0x2E, 0x27, 0x2F, 0x30, 0x10, 0x2A, 0x31, 0x32, 0x0D,
+  0x05, 0x2C, 0x0F, 0x18, 0x18, 0x18, 0x0F, 0x33, 0x34, 0x18, 0x18, 0x18, 0x18, 0x0F, 0x2B, 0x35,
+  0x36, 0x2C, 0x0F, 0x18, 0x18, 0x18, 0x18, 0x37, 0x38, 0x0F, 0x18, 0x18, 0x18, 0x0F, 0x2B, 0x0D,
+  0x05, 0x39, 0x3A, 0x3A, 0x3B, 0x3B, 0x3C, 0x3D, 0x3E, 0x39, 0x3A, 0x3A, 0x3B, 0x3B, 0x3C, 0x3D,
+  0x3E, 0x39, 0x3A, 0x3A, 0x3B, 0x3B, 0x3C, 0x3D, 0x3E, 0x39, 0x3A, 0x3A, 0x3B, 0x3B, 0x3C, 0x0D,
+  0x05, 0x3F, 0x12, 0x40, 0x41, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x12, 0x40, 0x41, 0x41, 0x41,
+  0x41, 0x41, 0x41, 0x47, 0x14, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x41, 0x41, 0x47, 0x14, 0x4D, 0x0D,
+  0x05, 0x4E, 0x4F, 0x50, 0x41, 0x41, 0x51, 0x52, 0x53, 0x53, 0x46, 0x34, 0x54, 0x41, 0x41, 0x55,
+  0x56, 0x41, 0x41, 0x57, 0x37, 0x48, 0x58, 0x58, 0x59, 0x5A, 0x41, 0x41, 0x5B, 0x5C, 0x5D, 0x0D,
+  0x05, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x5E, 0x53, 0x53, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0C,
+  0x0C, 0x06, 0x07, 0x07, 0x08, 0x08, 0x58, 0x58, 0x5E, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0D,
+  0x5F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F, 0x11, 0x53, 0x60, 0x10, 0x10, 0x10, 0x0F, 0x0F, 0x0C,
+  0x0C, 0x0F, 0x0F, 0x10, 0x10, 0x10, 0x61, 0x58, 0x11, 0x0F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x62,
+  0x63, 0x64, 0x64, 0x64, 0x64, 0x65, 0x19, 0x66, 0x53, 0x12, 0x67, 0x67, 0x68, 0x69, 0x0F, 0x6A,
+  0x6B, 0x0F, 0x6C, 0x6D, 0x67, 0x67, 0x14, 0x58, 0x6E, 0x1F, 0x6F, 0x64, 0x64, 0x64, 0x64, 0x70,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x71, 0x72, 0x27, 0x53, 0x1A, 0x18, 0x18, 0x73, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x74, 0x18, 0x18, 0x1E, 0x58, 0x27, 0x71, 0x72, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x71, 0x72, 0x33, 0x53, 0x53, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x58, 0x58, 0x38, 0x71, 0x72, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x75, 0x72, 0x3D, 0x53, 0x53, 0x0F, 0x76, 0x77, 0x78, 0x79, 0x7A,
+  0x7A, 0x7B, 0x78, 0x7C, 0x7D, 0x0F, 0x58, 0x58, 0x3E, 0x71, 0x7E, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x64, 0x64, 0x64, 0x64, 0x64, 0x7F, 0x51, 0x43, 0x5A, 0x80, 0x0F, 0x1D, 0x05, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0D, 0x1C, 0x0F, 0x81, 0x51, 0x4B, 0x5A, 0x82, 0x64, 0x64, 0x64, 0x64, 0x64,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x83, 0x0F, 0x0F, 0x0F, 0x1D, 0x05, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0D, 0x1C, 0x0F, 0x0F, 0x0F, 0x83, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x14, 0x5E, 0x12, 0x42, 0x0F, 0x1D, 0x05, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0D, 0x1C, 0x0F, 0x4C, 0x14, 0x5E, 0x12, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84,
+  0x64, 0x64, 0x64, 0x64, 0x64, 0x85, 0x72, 0x11, 0x1A, 0x53, 0x0F, 0x6C, 0x86, 0x87, 0x88, 0x88,
+  0x88, 0x88, 0x88, 0x89, 0x5C, 0x0F, 0x58, 0x1E, 0x11, 0x71, 0x8A, 0x64, 0x64, 0x64, 0x64, 0x64,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x71, 0x72, 0x66, 0x53, 0x53, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x58, 0x58, 0x6E, 0x71, 0x72, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x71, 0x72, 0x27, 0x53, 0x53, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x58, 0x58, 0x27, 0x71, 0x72, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+  0x8B, 0x84, 0x84, 0x84, 0x84, 0x8C, 0x72, 0x33, 0x53, 0x53, 0x0F, 0x76, 0x8D, 0x64, 0x64, 0x64,
+  0x64, 0x64, 0x64, 0x8E, 0x7D, 0x0F, 0x58, 0x58, 0x38, 0x71, 0x8F, 0x84, 0x84, 0x84, 0x84, 0x90,
+  0x91, 0x64, 0x64, 0x64, 0x64, 0x64, 0x37, 0x3D, 0x5A, 0x92, 0x0F, 0x0F, 0x93, 0x64, 0x64, 0x94,
+  0x95, 0x64, 0x64, 0x96, 0x0F, 0x0F, 0x97, 0x51, 0x3E, 0x34, 0x64, 0x64, 0x64, 0x64, 0x64, 0x98,
+  0x05, 0x3F, 0x46, 0x46, 0x48, 0x48, 0x4D, 0x43, 0x4B, 0x3F, 0x46, 0x46, 0x48, 0x48, 0x4D, 0x0C,
+  0x0C, 0x3F, 0x46, 0x46, 0x48, 0x48, 0x4D, 0x43, 0x4B, 0x3F, 0x46, 0x46, 0x48, 0x48, 0x4D, 0x0D,
+  0x05, 0x99, 0x12, 0x84, 0x84, 0x84, 0x14, 0x83, 0x4C, 0x84, 0x84, 0x84, 0x84, 0x14, 0x9A, 0x0C,
+  0x0C, 0x99, 0x12, 0x84, 0x84, 0x84, 0x84, 0x42, 0x83, 0x12, 0x84, 0x84, 0x84, 0x14, 0x9A, 0x0D,
+  0x05, 0x06, 0x4F, 0x9B, 0x84, 0x14, 0x72, 0x5E, 0x9C, 0x84, 0x84, 0x84, 0x9D, 0x5C, 0x09, 0x9E,
+  0x9F, 0x06, 0x4F, 0x9B, 0x84, 0x84, 0x84, 0xA0, 0x5E, 0x71, 0x12, 0x84, 0x9D, 0x5C, 0x09, 0x0D,
+  0x05, 0xA1, 0xA2, 0xA3, 0xA4, 0x72, 0x72, 0x11, 0x11, 0x0E, 0xA3, 0xA3, 0xA4, 0xA4, 0x13, 0x0F,
+  0x0F, 0x0E, 0xA3, 0xA3, 0xA4, 0xA4, 0x13, 0x11, 0x11, 0x71, 0x71, 0xA3, 0xA4, 0xA5, 0xA6, 0x0D,
+  0x05, 0xA7, 0xA8, 0xA3, 0xA4, 0x72, 0x72, 0xA9, 0xAA, 0xAA, 0xAB, 0x0F, 0x0F, 0xAC, 0xAD, 0x0F,
+  0x0F, 0xAA, 0xAE, 0x0F, 0x0F, 0xAF, 0xAD, 0xAD, 0xB0, 0x71, 0x71, 0xA3, 0xA4, 0xB1, 0xB2, 0x0D,
+  0xB3, 0x18, 0xB4, 0xAE, 0xAC, 0x72, 0x72, 0x27, 0xB5, 0xB6, 0xAE, 0xB7, 0xB8, 0x18, 0x18, 0x18,
+  0x18, 0x18, 0x18, 0xB9, 0xBA, 0xAC, 0xBB, 0xBC, 0x27, 0x71, 0x71, 0xAE, 0xAC, 0xBD, 0x18, 0xBE,
+  0xBF, 0x18, 0x73, 0x3A, 0x3B, 0x74, 0x37, 0x33, 0x53, 0x53, 0x3A, 0x0F, 0x74, 0x18, 0x18, 0xC0,
+  0xC1, 0x18, 0x18, 0x73, 0x0F, 0x3B, 0x58, 0x58, 0x38, 0x34, 0x73, 0x3A, 0x3B, 0x74, 0x18, 0xC2,
+  0x05, 0xC3, 0x3A, 0xC4, 0xC5, 0x3B, 0xC6, 0x3D, 0x53, 0x53, 0x3A, 0xC4, 0xC5, 0x3B, 0xC6, 0x0C,
+  0x0C, 0xC3, 0x3A, 0xC4, 0xC5, 0x3B, 0x58, 0x58, 0x3E, 0xC3, 0x3A, 0xC4, 0xC5, 0x3B, 0xC6, 0x0D,
+  0x05, 0x3F, 0x12, 0x40, 0x41, 0x41, 0x41, 0x41, 0xC7, 0xC8, 0x41, 0x41, 0x47, 0x14, 0x4D, 0x0C,
+  0x0C, 0x3F, 0x12, 0x40, 0x41, 0x41, 0xC9, 0xCA, 0x41, 0x41, 0x41, 0x41, 0x47, 0x14, 0x4D, 0x0D,
+  0x05, 0x99, 0x4F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x5C, 0x9A, 0xCB,
+  0xCC, 0x99, 0x4F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x5C, 0x9A, 0x0D,
+  0x05, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0xCD, 0xCE, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0xCD,
+  0xCE, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0xCD, 0xCE, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x0D,
+  0x5F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x62,
+  0x63, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64,
+  0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x70
+};
+
+// 4 rows of 4 pixels per tile, pixel c of a row in bits 2c and 2c + 1
+const uint8_t pacManTileAtlas[828] PROGMEM = {
+  0x54, 0x45, 0x51, 0x15, 0x55, 0x55, 0x55, 0x00, 0x55, 0x01, 0x05, 0x14, 0x55, 0x40, 0x50, 0x14,
+  0x15, 0x51, 0x45, 0x54, 0x15, 0x15, 0x15, 0x15, 0x00, 0x00, 0xA0, 0xA0, 0x00, 0x00, 0x80, 0x80,
+  0x00, 0x00, 0x02, 0x02, 0x00, 0x00, 0x0A, 0x0A, 0x00, 0x00, 0x28, 0x08, 0x00, 0x00, 0x28, 0x20,
+  0x14, 0x14, 0x14, 0x14, 0x54, 0x54, 0x54, 0x54, 0x00, 0x00, 0x00, 0xA0, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x0A,
+  0x00, 0x00, 0x00, 0x01, 0x00, 0xA0, 0xA8, 0xAA, 0x40, 0x40, 0x42, 0x42, 0x55, 0x00, 0x01, 0x01,
+  0x55, 0x00, 0x00, 0x00, 0x01, 0x05, 0x05, 0x05, 0x50, 0x10, 0x10, 0x10, 0x55, 0x00, 0x40, 0x40,
+  0x01, 0x01, 0x01, 0x01, 0x40, 0x40, 0x40, 0x40, 0x05, 0x04, 0x04, 0x04, 0x40, 0x50, 0x50, 0x50,
+  0x01, 0x01, 0x81, 0x81, 0x00, 0x0A, 0x2A, 0xAA, 0xAA, 0xA8, 0xA0, 0x00, 0x42, 0x42, 0x40, 0x40,
+  0x01, 0x01, 0x00, 0x51, 0x00, 0x00, 0x00, 0x45, 0x05, 0x05, 0x05, 0x01, 0x28, 0x00, 0x00, 0x00,
+  0x10, 0x10, 0x10, 0x50, 0x00, 0x00, 0x00, 0x54, 0x40, 0x40, 0x00, 0x45, 0x0A, 0x00, 0x00, 0x00,
+  0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x04, 0x04, 0x04, 0x05, 0x50, 0x50, 0x50, 0x40,
+  0x00, 0x00, 0x00, 0x51, 0x81, 0x81, 0x01, 0x01, 0xAA, 0x2A, 0x0A, 0x00, 0x28, 0x08, 0x00, 0x00,
+  0x40, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+  0x28, 0x20, 0x00, 0x00, 0xA0, 0xA0, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x02, 0x02, 0x00, 0x00,
+  0x0A, 0x0A, 0x00, 0x00, 0x08, 0x28, 0x00, 0x00, 0x20, 0x28, 0x00, 0x00, 0x00, 0xA0, 0xA0, 0x00,
+  0x00, 0x54, 0x55, 0x01, 0x00, 0x55, 0x55, 0x00, 0x00, 0x00, 0x01, 0x05, 0x00, 0x28, 0x08, 0x00,
+  0x00, 0x40, 0x50, 0x10, 0x00, 0x05, 0x15, 0x10, 0x00, 0x80, 0x80, 0x00, 0x00, 0x15, 0x55, 0x40,
+  0x00, 0x02, 0x02, 0x00, 0x00, 0x50, 0x54, 0x04, 0x00, 0x01, 0x05, 0x04, 0x00, 0x28, 0x20, 0x00,
+  0x00, 0x00, 0x40, 0x50, 0x00, 0x0A, 0x0A, 0x00, 0x00, 0x20, 0xA0, 0x00, 0x40, 0x40, 0x00, 0x00,
+  0x01, 0x55, 0x55, 0x00, 0x05, 0x01, 0x00, 0x00, 0x00, 0x08, 0x28, 0x00, 0x10, 0x10, 0x10, 0x10,
+  0x01, 0x55, 0x54, 0x00, 0x00, 0x01, 0x05, 0x14, 0x00, 0x40, 0x50, 0x14, 0x40, 0x55, 0x15, 0x00,
+  0x04, 0x04, 0x04, 0x04, 0x00, 0x20, 0x28, 0x00, 0x50, 0x40, 0x00, 0x00, 0x40, 0x55, 0x55, 0x00,
+  0x01, 0x01, 0x00, 0x00, 0x00, 0x08, 0x0A, 0x00, 0x00, 0x00, 0x28, 0x28, 0x15, 0x15, 0x15, 0x51,
+  0x10, 0x10, 0x10, 0x40, 0x04, 0x04, 0x04, 0x01, 0x54, 0x54, 0x54, 0x45, 0x45, 0x54, 0x00, 0x00,
+  0x55, 0x55, 0x00, 0x00, 0x55, 0x15, 0x50, 0x50, 0x00, 0x00, 0x00, 0x08, 0x55, 0x00, 0x00, 0x55,
+  0x55, 0x00, 0x40, 0x55, 0x01, 0x01, 0x01, 0x00, 0x14, 0x14, 0x14, 0x50, 0x14, 0x14, 0x14, 0x05,
+  0x40, 0x40, 0x40, 0x00, 0x55, 0x00, 0x01, 0x55, 0x00, 0x00, 0x00, 0x20, 0x55, 0x54, 0x05, 0x05,
+  0x51, 0x15, 0x00, 0x00, 0x50, 0x50, 0x50, 0x50, 0x05, 0x05, 0x05, 0x05, 0x15, 0x00, 0x00, 0x00,
+  0x54, 0x00, 0x00, 0x00, 0x50, 0x50, 0x50, 0x55, 0x00, 0x00, 0x40, 0x40, 0x00, 0x55, 0x51, 0x55,
+  0x00, 0x55, 0x55, 0x55, 0x00, 0x55, 0x91, 0x55, 0x00, 0x00, 0xAA, 0x00, 0x00, 0x55, 0x46, 0x55,
+  0x00, 0x55, 0x45, 0x55, 0x00, 0x00, 0x01, 0x01, 0x05, 0x05, 0x05, 0x55, 0x15, 0x55, 0x00, 0x00,
+  0x14, 0x05, 0x00, 0x00, 0x14, 0x50, 0x00, 0x00, 0x54, 0x55, 0x00, 0x00, 0x00, 0x00, 0x28, 0x00,
+  0x00, 0x00, 0x55, 0x55, 0x15, 0x55, 0x50, 0x50, 0x15, 0x55, 0x51, 0x55, 0x00, 0x55, 0x01, 0x55,
+  0x00, 0x55, 0x00, 0x55, 0x54, 0x55, 0x45, 0x55, 0x54, 0x55, 0x05, 0x05, 0x00, 0x00, 0x40, 0x54,
+  0x50, 0x50, 0x51, 0x15, 0x54, 0x55, 0x01, 0x01, 0x15, 0x55, 0x40, 0x40, 0x05, 0x05, 0x45, 0x54,
+  0x00, 0x00, 0x01, 0x15, 0x45, 0x51, 0x15, 0x15, 0x15, 0x05, 0x00, 0x00, 0x55, 0x54, 0x00, 0x00,
+  0x01, 0x05, 0x14, 0x14, 0x40, 0x50, 0x14, 0x14, 0x55, 0x15, 0x00, 0x00, 0x54, 0x50, 0x00, 0x00,
+  0x51, 0x45, 0x54, 0x54, 0x00, 0x00, 0xA0, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x01, 0x55, 0x54,
+  0x10, 0x10, 0x40, 0x00, 0x00, 0x40, 0x55, 0x15, 0x14, 0x14, 0x50, 0x00, 0x14, 0x14, 0x05, 0x00,
+  0x04, 0x04, 0x01, 0x00, 0x00, 0xA8, 0xAA, 0xAA, 0x00, 0x00, 0x02, 0x82, 0x00, 0x00, 0x00, 0x80,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x80, 0x82, 0x00, 0x2A, 0xAA, 0xAA, 0xAA, 0xA8, 0x00, 0x00,
+  0x82, 0x02, 0x00, 0x00, 0x08, 0x00, 0x00, 0x08, 0x20, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80,
+  0x02, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x02,
+  0x20, 0x00, 0x00, 0x20, 0x82, 0x80, 0x00, 0x00, 0xAA, 0x2A, 0x00, 0x00, 0x51, 0x01, 0x01, 0x01,
+  0x15, 0x50, 0x50, 0x50, 0x40, 0x50, 0x10, 0x10, 0x05, 0x14, 0x10, 0x10, 0x00, 0x00, 0x40, 0x00,
+  0x54, 0x01, 0x01, 0x01, 0x15, 0x40, 0x40, 0x40, 0x00, 0x00, 0x01, 0x00, 0x50, 0x14, 0x04, 0x04,
+  0x01, 0x05, 0x04, 0x04, 0x54, 0x05, 0x05, 0x05, 0x45, 0x40, 0x40, 0x40, 0x51, 0x15, 0x15, 0x15,
+  0x05, 0x14, 0x14, 0x14, 0x50, 0x14, 0x14, 0x14, 0x45, 0x54, 0x54, 0x54, 0x00, 0xA0, 0x00, 0x00,
+  0x00, 0x80, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x10, 0x15, 0x05, 0x00,
+  0x10, 0x50, 0x40, 0x00, 0x04, 0x05, 0x01, 0x00, 0x04, 0x54, 0x50, 0x00, 0x14, 0x54, 0x50, 0x00,
+  0x14, 0x15, 0x05, 0x00, 0x00, 0x00, 0x08, 0x28, 0x00, 0x00, 0x20, 0x28
+};
@@ -0,0 +1,16 @@
+/*
+ * Tile map of the PacMan maze (Pac-man.lcd reduced to black, wall and dot
+ * pixels), drawn with lcd_tiles.
+ */
+
+#ifndef _PACMAN_TILES_H
+#define _PACMAN_TILES_H
+
+#define PACMAN_TILE_BLACK 0
+#define PACMAN_TILE_WALL 1
+#define PACMAN_TILE_DOT 2
+
+extern const uint8_t pacManTileMap[1152];  // 32 x 36 tiles
+extern const uint8_t pacManTileAtlas[828]; // 207 tiles
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Recording and replaying of games. A recording holds the custom menu
+ * settings, the random seed of every level and the joystick input of
+ * every frame in which it changed, together with a hash of the game state
+ * so a replay that no longer matches the recording is detected.
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <SD.h>
+
+#include "replay.h"
+
+#define REPLAY_SEED 1
+#define REPLAY_INPUT 2
+#define REPLAY_END 3
+
+#define REPLAY_OFF 0
+#define REPLAY_RECORDING 1
+#define REPLAY_PLAYING 2
+
+static File replay_file;
+static uint8_t replay_state = REPLAY_OFF;
+static uint32_t replay_frame; // frames since the last INPUT record
+static uint8_t replay_last_input; // input of the last INPUT record
+static uint8_t replay_tag; // replaying: tag of the record read ahead
+static uint32_t replay_wait; // replaying: frames until the read ahead INPUT record
+
+// Writes an unsigned LEB128 varint
+static void replay_write_varint(uint32_t value) {
+  while (value >= 0x80) {
+    replay_file.write((uint8_t) (value | 0x80));
+    value >>= 7;
+  }
+  replay_file.write((uint8_t) value);
+}
+
+// Reads an unsigned LEB128 varint
+static uint32_t replay_read_varint() {
+  uint32_t value = 0;
+  int c;
+
+  for (uint8_t shift = 0; shift < 32; shift += 7) {
+    if ((c = replay_file.read()) < 0) {
+      break;
+    }
+    value |= (uint32_t) (c & 0x7F) << shift;
+    if (!(c & 0x80)) {
+      break;
+    }
+  }
+  return value;
+}
+
+static void replay_write_hash(uint16_t hash) {
+  replay_file.write((uint8_t) hash);
+  replay_file.write((uint8_t) (hash >> 8));
+}
+
+static uint16_t replay_read_hash() {
+  uint16_t hash = replay_file.read() & 0xFF;
+  return hash | ((replay_file.read() & 0xFF) << 8);
+}
+
+// Reads the tag of the next record, and for INPUT and END records
+// how many frames away it is
+static void replay_read_ahead() {
+  int c = replay_file.read();
+
+  replay_tag = (c < 0) ? (REPLAY_END << 4) : c;
+  replay_wait = ((replay_tag >> 4) == REPLAY_SEED) ? 0 : replay_read_varint();
+}
+
+// Stops a replay that no longer matches the game, control goes back to the joystick
+static void replay_stop(const char *reason) {
+  Serial.print("Replay stopped: ");
+  Serial.println(reason);
+  replay_file.close();
+  replay_state = REPLAY_OFF;
+}
+
+bool replay_record(const char *file_name) {
+  if (SD.exists(file_name)) {
+    SD.remove(file_name); // opening for write appends
+  }
+  if (!(replay_file = SD.open(file_name, FILE_WRITE))) {
+    Serial.println("Replay file could not be created");
+    return false;
+  }
+  replay_file.write('P');
+  replay_file.write('R');
+  replay_file.write(REPLAY_VERSION);
+  replay_state = REPLAY_RECORDING;
+  replay_frame = 0;
+  replay_last_input = 0;
+  return true;
+}
+
+bool replay_play(const char *file_name) {
+  if (!(replay_file = SD.open(file_name))) {
+    Serial.println("Replay file not found");
+    return false;
+  }
+  if (replay_file.read() != 'P' || replay_file.read() != 'R' ||
+      replay_file.read() != REPLAY_VERSION) {
+    Serial.println("Not a replay file");
+    replay_file.close();
+    return false;
+  }
+  replay_state = REPLAY_PLAYING;
+  replay_frame = 0;
+  replay_last_input = 0;
+  return true;
+}
+
+bool replay_active() {
+  return replay_state != REPLAY_OFF;
+}
+
+void replay_settings(int *settings, uint8_t count) {
+  if (replay_state == REPLAY_RECORDING) {
+    replay_write_varint(count);
+    for (uint8_t i = 0; i < count; i++) {
+      replay_write_varint(settings[i]);
+    }
+  }
+  else if (replay_state == REPLAY_PLAYING) {
+    uint8_t recorded = replay_read_varint();
+    for (uint8_t i = 0; i < recorded; i++) {
+      int setting = replay_read_varint();
+      if (i < count) {
+	settings[i] = setting;
+      }
+    }
+    replay_read_ahead();
+  }
+}
+
+uint32_t replay_seed(uint32_t seed) {
+  if (replay_state == REPLAY_RECORDING) {
+    replay_file.write((uint8_t) (REPLAY_SEED << 4));
+    replay_write_varint(seed);
+  }
+  else if (replay_state == REPLAY_PLAYING) {
+    if ((replay_tag >> 4) != REPLAY_SEED) {
+      replay_stop("level started at a different frame");
+      return seed;
+    }
+    seed = replay_read_varint();
+    replay_read_ahead();
+  }
+  return seed;
+}
+
+uint8_t replay_input(uint8_t input, uint16_t (*hash)()) {
+  if (replay_state == REPLAY_RECORDING) {
+    // Writes a record when the input changes, or every REPLAY_KEYFRAME
+    // frames so a replay can't drift for long without being noticed
+    if (input != replay_last_input || replay_frame >= REPLAY_KEYFRAME) {
+      replay_file.write((uint8_t) ((REPLAY_INPUT << 4) | input));
+      replay_write_varint(replay_frame);
+      replay_write_hash(hash());
+      replay_last_input = input;
+      replay_frame = 0;
+    }
+    replay_frame++;
+  }
+  else if (replay_state == REPLAY_PLAYING) {
+    // A level start is never more than a keyframe away in the recording
+    if ((replay_tag >> 4) == REPLAY_SEED && replay_frame > REPLAY_KEYFRAME + 1) {
+      replay_stop("level did not start when recorded");
+      return input;
+    }
+    if (replay_frame == replay_wait) {
+      if ((replay_tag >> 4) != REPLAY_INPUT) {
+	replay_stop("recording ended early");
+	return input;
+      }
+      if (replay_read_hash() != hash()) {
+	replay_stop("game state differs from the recording");
+	return input;
+      }
+      replay_last_input = replay_tag & 0x0F;
+      replay_frame = 0;
+      replay_read_ahead();
+    }
+    replay_frame++;
+    return replay_last_input;
+  }
+  return input;
+}
+
+void replay_end(uint16_t (*hash)()) {
+  if (replay_state == REPLAY_RECORDING) {
+    replay_file.write((uint8_t) (REPLAY_END << 4));
+    replay_write_varint(replay_frame);
+    replay_write_hash(hash());
+    replay_file.close();
+    replay_state = REPLAY_OFF;
+  }
+  else if (replay_state == REPLAY_PLAYING) {
+    if ((replay_tag >> 4) != REPLAY_END || replay_frame != replay_wait ||
+	replay_read_hash() != hash()) {
+      replay_stop("game ended at a different frame or state");
+      return;
+    }
+    Serial.println("Replay matched the recording");
+    replay_file.close();
+    replay_state = REPLAY_OFF;
+  }
+}
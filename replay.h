@@ -0,0 +1,67 @@
+/*
+ * Recording and replaying of games. A recording holds the custom menu
+ * settings, the random seed of every level and the joystick input of
+ * every frame in which it changed, together with a hash of the game state
+ * so a replay that no longer matches the recording is detected.
+ *
+ * File layout (integers are unsigned LEB128 varints):
+ *   'P' 'R' version count settings[count]
+ *   records, each starting with a tag byte (type << 4 | input):
+ *     SEED  : seed
+ *     INPUT : frames since previous INPUT, hash (2 bytes, low first)
+ *     END   : frames since previous INPUT, hash (2 bytes, low first)
+ */
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#define REPLAY_VERSION 2
+#define REPLAY_KEYFRAME 32 // frames between hash checks when the input doesn't change
+
+/* Starts recording a game to a file on the SD card, replacing the file
+ * if it already exists.
+ *
+ * file_name : name of the file to record to
+ * returns   : false if the file could not be created
+ */
+bool replay_record(const char *file_name);
+
+/* Starts replaying a game recorded with replay_record.
+ *
+ * file_name : name of the file to replay
+ * returns   : false if the file is missing or not a recording
+ */
+bool replay_play(const char *file_name);
+
+/* True while recording or replaying. */
+bool replay_active();
+
+/* Records the game settings, or replaces them with the recorded ones
+ * when replaying. Does nothing otherwise.
+ *
+ * settings : the settings array
+ * count    : number of settings
+ */
+void replay_settings(int *settings, uint8_t count);
+
+/* Records the random seed of a level, or returns the recorded one when
+ * replaying. Returns seed otherwise.
+ */
+uint32_t replay_seed(uint32_t seed);
+
+/* Called once per frame with the joystick input (0-15). Records the input
+ * or returns the recorded one when replaying, otherwise returns input.
+ *
+ * input   : the input read from the joystick
+ * hash    : computes a hash of the game state, only called on frames
+ *           where the hash is written or checked
+ */
+uint8_t replay_input(uint8_t input, uint16_t (*hash)());
+
+/* Finishes recording or checks the end of the replay.
+ *
+ * hash    : computes a hash of the game state
+ */
+void replay_end(uint16_t (*hash)());
+
+#endif
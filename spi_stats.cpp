@@ -0,0 +1,133 @@
+/*
+ * Display traffic accounting. Counts the address windows and pixels sent
+ * to the LCD display per drawing routine and prints them per frame.
+ */
+
+#include <Adafruit_GFX.h>    // Core graphics library
+#include <Adafruit_ST7735.h> // Hardware-specific library
+
+#include "spi_stats.h"
+
+typedef struct {
+  const char *name;
+  uint32_t windows;
+  uint32_t pixels;
+} spi_routine_t;
+
+static spi_routine_t spi_routines[SPI_STATS_MAX_ROUTINES] = {{"other", 0, 0}};
+static uint8_t spi_num_routines = 1;
+static uint8_t spi_current = 0; // routine being counted
+static uint16_t spi_frames = 0;
+
+void spi_stats_window(uint32_t pixels) {
+  spi_routines[spi_current].windows++;
+  spi_routines[spi_current].pixels += pixels;
+}
+
+uint8_t spi_stats_enter(const char *name) {
+  uint8_t previous = spi_current;
+  uint8_t i;
+
+  for (i = 0; i < spi_num_routines; i++) {
+    if (spi_routines[i].name == name) {
+      break;
+    }
+  }
+  // A full table counts new routines as "other"
+  if (i == spi_num_routines) {
+    if (spi_num_routines == SPI_STATS_MAX_ROUTINES) {
+      i = 0;
+    }
+    else {
+      spi_routines[i].name = name;
+      spi_routines[i].windows = 0;
+      spi_routines[i].pixels = 0;
+      spi_num_routines++;
+    }
+  }
+  spi_current = i;
+  return previous;
+}
+
+void spi_stats_leave(uint8_t previous) {
+  spi_current = previous;
+}
+
+void spi_stats_frame_end() {
+  if (++spi_frames == SPI_STATS_FRAMES) {
+    spi_stats_report();
+  }
+}
+
+void spi_stats_report() {
+  uint32_t frames = max(spi_frames, 1);
+  uint32_t total = 0;
+
+  Serial.print("Display traffic per frame over ");
+  Serial.print(frames);
+  Serial.println(" frames:");
+  for (uint8_t i = 0; i < spi_num_routines; i++) {
+    spi_routine_t *routine = &spi_routines[i];
+    uint32_t bytes = routine->windows * SPI_STATS_WINDOW_BYTES
+      + routine->pixels * SPI_STATS_PIXEL_BYTES;
+
+    // Bus time is 8 bits per byte, the gaps between bytes are not counted
+    if (routine->windows == 0) {
+      continue;
+    }
+    Serial.print(routine->name);
+    Serial.print(": ");
+    Serial.print((double) routine->windows / frames, 1);
+    Serial.print(" windows, ");
+    Serial.print(routine->pixels / frames);
+    Serial.print(" pixels, ");
+    Serial.print(bytes / frames);
+    Serial.print(" bytes, ");
+    Serial.print(bytes / frames * 8 / (SPI_STATS_CLOCK / 1000000UL));
+    Serial.println(" us");
+    total += bytes;
+    routine->windows = 0;
+    routine->pixels = 0;
+  }
+  Serial.print("Total: ");
+  Serial.print(total / frames);
+  Serial.print(" bytes, ");
+  Serial.print(total / frames * 8 / (SPI_STATS_CLOCK / 1000000UL));
+  Serial.println(" us on the bus");
+  spi_frames = 0;
+}
+
+// Counts a w by h rectangle at x, y drawn through one address window, only its part on the screen is sent
+static void spi_stats_rect(Adafruit_GFX *gfx, int16_t x, int16_t y,
+			   int16_t w, int16_t h) {
+#ifdef SPI_STATS
+  int16_t x1 = min(x + w, gfx->width());
+  int16_t y1 = min(y + h, gfx->height());
+
+  x = max(x, 0);
+  y = max(y, 0);
+  if (x1 > x && y1 > y) {
+    spi_stats_window((uint32_t) (x1 - x) * (y1 - y));
+  }
+#endif
+}
+
+void spi_stats_tft::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  spi_stats_rect(this, x, y, 1, 1);
+  Adafruit_ST7735::drawPixel(x, y, color);
+}
+
+void spi_stats_tft::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  spi_stats_rect(this, x, y, 1, h);
+  Adafruit_ST7735::drawFastVLine(x, y, h, color);
+}
+
+void spi_stats_tft::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  spi_stats_rect(this, x, y, w, 1);
+  Adafruit_ST7735::drawFastHLine(x, y, w, color);
+}
+
+void spi_stats_tft::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  spi_stats_rect(this, x, y, w, h);
+  Adafruit_ST7735::fillRect(x, y, w, h, color);
+}
@@ -0,0 +1,76 @@
+/*
+ * Display traffic accounting. Counts the address windows and pixels sent
+ * to the LCD display, the bytes they take on the SPI bus and the time
+ * those bytes need at the bus clock, per drawing routine, and prints the
+ * averages per frame every SPI_STATS_FRAMES frames.
+ *
+ * Drawing through the Adafruit_GFX primitives is counted by drawing with
+ * an spi_stats_tft. Code that pushes pixels itself (setAddrWindow and
+ * pushColor) counts them with SPI_STATS_WINDOW. The SPI_STATS_ macros
+ * compile to nothing unless SPI_STATS is defined.
+ */
+
+#ifndef _SPI_STATS_H
+#define _SPI_STATS_H
+
+#define SPI_STATS_FRAMES 64 // frames between reports
+#define SPI_STATS_MAX_ROUTINES 16 // routines counted apart, the rest go to "other"
+#define SPI_STATS_CLOCK 8000000UL // SPI clock of the display in Hz
+#define SPI_STATS_WINDOW_BYTES 11 // CASET and RASET with 4 data bytes each, then RAMWR
+#define SPI_STATS_PIXEL_BYTES 2
+
+/* Counts one address window and the pixels sent to it.
+ *
+ * pixels : number of pixels pushed to the window
+ */
+void spi_stats_window(uint32_t pixels);
+
+/* Makes name the routine traffic is counted for.
+ *
+ * name    : routine name, the string must outlive the counts
+ * returns : the previous routine, for spi_stats_leave
+ */
+uint8_t spi_stats_enter(const char *name);
+
+/* Goes back to counting for the routine spi_stats_enter replaced. */
+void spi_stats_leave(uint8_t previous);
+
+/* Ends a frame, every SPI_STATS_FRAMES frames the counts are printed and
+ * start over.
+ */
+void spi_stats_frame_end();
+
+/* Prints the traffic per frame of every routine since the last report. */
+void spi_stats_report();
+
+// Counts the traffic of the enclosing scope for a routine
+struct spi_stats_scope_t {
+  uint8_t previous;
+
+  spi_stats_scope_t(const char *name) : previous(spi_stats_enter(name)) {}
+  ~spi_stats_scope_t() { spi_stats_leave(previous); }
+};
+
+// Display that counts what the Adafruit_GFX drawing primitives send
+class spi_stats_tft : public Adafruit_ST7735 {
+ public:
+  spi_stats_tft(int8_t cs, int8_t dc, int8_t rst)
+    : Adafruit_ST7735(cs, dc, rst) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+};
+
+#ifdef SPI_STATS
+#define SPI_STATS_SCOPE(name) spi_stats_scope_t spi_stats_scope(name)
+#define SPI_STATS_WINDOW(pixels) spi_stats_window(pixels)
+#define SPI_STATS_FRAME_END() spi_stats_frame_end()
+#else
+#define SPI_STATS_SCOPE(name)
+#define SPI_STATS_WINDOW(pixels)
+#define SPI_STATS_FRAME_END()
+#endif
+
+#endif
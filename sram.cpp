@@ -0,0 +1,53 @@
+/*
+ * SRAM headroom monitor. The free SRAM between the heap and the stack is
+ * painted with a pattern at start-up and scanned for the pattern later.
+ */
+
+#include <Arduino.h>
+
+#include "sram.h"
+
+extern "C" char __heap_start; // end of the static variables (avr-libc)
+extern "C" char *__brkval;    // top of the heap, 0 until the first allocation
+
+// First byte above the heap
+static uint8_t *sram_heap_top() {
+  return (uint8_t *) (__brkval != 0 ? __brkval : &__heap_start);
+}
+
+void sram_paint() {
+  uint8_t *stack = (uint8_t *) SP - SRAM_MARGIN;
+
+  for (uint8_t *p = sram_heap_top(); p < stack; p++) {
+    *p = SRAM_PAINT;
+  }
+}
+
+uint16_t sram_free() {
+  return (uint8_t *) SP - sram_heap_top();
+}
+
+uint16_t sram_headroom() {
+  uint8_t *p = sram_heap_top();
+  uint8_t *stack = (uint8_t *) SP;
+
+  // The stack never reached the painted bytes left above the heap
+  while (p < stack && *p == SRAM_PAINT) {
+    p++;
+  }
+  return p - sram_heap_top();
+}
+
+uint16_t sram_stack_peak() {
+  return (uint8_t *) RAMEND - (sram_heap_top() + sram_headroom());
+}
+
+void sram_report(const char *where) {
+  Serial.print(where);
+  Serial.print(": ");
+  Serial.print(sram_free());
+  Serial.print(" bytes free, stack peak ");
+  Serial.print(sram_stack_peak());
+  Serial.print(", headroom ");
+  Serial.println(sram_headroom());
+}
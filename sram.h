@@ -0,0 +1,42 @@
+/*
+ * SRAM headroom monitor. The free SRAM between the heap and the stack is
+ * painted with a pattern at start-up, the stack wipes the pattern out as
+ * it grows, so how deep it ever reached can be read back at any time.
+ *
+ * SRAM_REPORT() prints the numbers over Serial when SRAM_MONITOR is
+ * defined and compiles to nothing otherwise.
+ */
+
+#ifndef _SRAM_H
+#define _SRAM_H
+
+#define SRAM_PAINT 0xC5 // pattern of SRAM the stack has not reached
+#define SRAM_MARGIN 16 // bytes under the stack pointer left alone while painting
+
+/* Paints the SRAM between the heap and the stack, call it first thing. */
+void sram_paint();
+
+/* Bytes between the top of the heap and the stack pointer right now. */
+uint16_t sram_free();
+
+/* Deepest the stack has been since sram_paint, in bytes. */
+uint16_t sram_stack_peak();
+
+/* Fewest bytes there have been between the heap and the stack since
+ * sram_paint, 0 means they may have collided.
+ */
+uint16_t sram_headroom();
+
+/* Prints free SRAM, stack peak and headroom over Serial.
+ *
+ * where : printed first, to tell reports apart
+ */
+void sram_report(const char *where);
+
+#ifdef SRAM_MONITOR
+#define SRAM_REPORT(where) sram_report(where)
+#else
+#define SRAM_REPORT(where)
+#endif
+
+#endif
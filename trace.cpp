@@ -0,0 +1,102 @@
+/*
+ * Timeline tracing. Scoped events are timed with micros() into a RAM
+ * buffer and appended to a Chrome trace (JSON array format) on the SD
+ * card. The closing ']' is left out, which the trace viewers allow, so
+ * the file is valid however the game is switched off.
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <SD.h>
+
+#include "trace.h"
+
+typedef struct {
+  const char *name;
+  uint32_t start;    // micros()
+  uint32_t duration; // micros
+  int16_t value;
+} trace_event_t;
+
+static File trace_file;
+static trace_event_t trace_events[TRACE_MAX_EVENTS];
+static uint8_t trace_count = 0;
+static bool trace_first = true; // no event written yet, so no separating comma
+static uint16_t trace_drops = 0;
+static uint16_t trace_frame = 0;
+static uint32_t trace_frame_start;
+
+bool trace_start(const char *file_name) {
+  SD.remove(file_name);
+  if (!(trace_file = SD.open(file_name, FILE_WRITE))) {
+    return false;
+  }
+  trace_file.print('[');
+  trace_file.flush();
+  trace_count = 0;
+  trace_first = true;
+  return true;
+}
+
+void trace_add(const char *name, uint32_t start, int16_t value) {
+  if (trace_count == TRACE_MAX_EVENTS) {
+    trace_drops++;
+    return;
+  }
+  trace_events[trace_count].name = name;
+  trace_events[trace_count].start = start;
+  trace_events[trace_count].duration = micros() - start;
+  trace_events[trace_count].value = value;
+  trace_count++;
+}
+
+void trace_frame_begin() {
+  trace_frame_start = micros();
+}
+
+void trace_frame_end() {
+  trace_add("frame", trace_frame_start, trace_frame++ & 0x7FFF); // kept clear of TRACE_NO_VALUE
+}
+
+void trace_idle() {
+  if (trace_count >= TRACE_FLUSH_EVENTS) {
+    trace_flush();
+  }
+}
+
+void trace_flush() {
+  uint32_t start = micros();
+
+  if (!trace_file) {
+    trace_count = 0;
+    return;
+  }
+  // Complete ("X") events, one per line
+  for (uint8_t i = 0; i < trace_count; i++) {
+    trace_event_t *event = &trace_events[i];
+
+    trace_file.print(trace_first ? "\n" : ",\n");
+    trace_file.print("{\"name\":\"");
+    trace_file.print(event->name);
+    trace_file.print("\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":");
+    trace_file.print(event->start);
+    trace_file.print(",\"dur\":");
+    trace_file.print(event->duration);
+    if (event->value != TRACE_NO_VALUE) {
+      trace_file.print(",\"args\":{\"value\":");
+      trace_file.print(event->value);
+      trace_file.print('}');
+    }
+    trace_file.print('}');
+    trace_first = false;
+  }
+  trace_file.flush();
+  trace_count = 0;
+
+  // The write itself shows up in the next flush
+  trace_add("trace_flush", start, TRACE_NO_VALUE);
+}
+
+uint16_t trace_dropped() {
+  return trace_drops;
+}
@@ -0,0 +1,78 @@
+/*
+ * Timeline tracing. Scoped events are timed with micros() into a RAM
+ * buffer and appended to a Chrome trace (JSON array format) on the SD
+ * card, which chrome://tracing and Perfetto open directly. Every frame
+ * is one event, the events inside it show what the frame was spent on.
+ *
+ * The TRACE_ macros compile to nothing unless TRACE is defined.
+ */
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#define TRACE_MAX_EVENTS 64 // events buffered in RAM
+#define TRACE_FLUSH_EVENTS 48 // buffered events that get written by trace_idle
+#define TRACE_NO_VALUE -1
+
+/* Starts a trace, replacing the file if it already exists.
+ *
+ * file_name : name of the file to write to
+ * returns   : false if the file could not be created
+ */
+bool trace_start(const char *file_name);
+
+/* Buffers an event that ends now. Events that don't fit are dropped.
+ *
+ * name  : event name, the string must outlive the trace
+ * start : micros() at the start of the event
+ * value : shown in the event arguments, TRACE_NO_VALUE for none
+ */
+void trace_add(const char *name, uint32_t start, int16_t value);
+
+/* Marks the start of a frame. */
+void trace_frame_begin();
+
+/* Adds the event of the frame started by trace_frame_begin. */
+void trace_frame_end();
+
+/* Writes the buffer to the card if it holds TRACE_FLUSH_EVENTS or more,
+ * call it when there is time to spare.
+ */
+void trace_idle();
+
+/* Writes every buffered event to the card. */
+void trace_flush();
+
+/* Number of events dropped because the buffer was full. */
+uint16_t trace_dropped();
+
+// Adds an event covering the rest of the enclosing scope
+struct trace_scope_t {
+  const char *name;
+  uint32_t start;
+  int16_t value;
+
+  trace_scope_t(const char *name, int16_t value)
+    : name(name), start(micros()), value(value) {}
+  ~trace_scope_t() { trace_add(name, start, value); }
+};
+
+#ifdef TRACE
+#define TRACE_START(file_name) trace_start(file_name)
+#define TRACE_SCOPE(name) trace_scope_t trace_scope(name, TRACE_NO_VALUE)
+#define TRACE_SCOPE_VALUE(name, value) trace_scope_t trace_scope(name, value)
+#define TRACE_CALL(call) { TRACE_SCOPE(#call); call; }
+#define TRACE_FRAME_BEGIN() trace_frame_begin()
+#define TRACE_FRAME_END() trace_frame_end()
+#define TRACE_IDLE() trace_idle()
+#else
+#define TRACE_START(file_name)
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_VALUE(name, value)
+#define TRACE_CALL(call) call
+#define TRACE_FRAME_BEGIN()
+#define TRACE_FRAME_END()
+#define TRACE_IDLE()
+#endif
+
+#endif